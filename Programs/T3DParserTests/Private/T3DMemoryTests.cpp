@@ -0,0 +1,113 @@
+#include "T3DParserTests.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/PlatformMemory.h"
+#include "T3DCorpusGenerator.h"
+#include "T3DLineCache.h"
+#include "T3DReader.h"
+
+namespace T3DTests
+{
+	// Text size of the actor blocks handed off at once, same as the level importer
+	static const int32 ActorBatchSize = 16 * 1024 * 1024;
+
+	// Memory the line readers and the cache writer keep whatever the size of the level: chunks, windows and file buffers
+	static const int64 ReaderBuffersSize = 64 * 1024 * 1024;
+
+	/** Resident memory of the process */
+	static int64 UsedPhysical()
+	{
+		return (int64)FPlatformMemory::GetStats().UsedPhysical;
+	}
+
+	void RunMemoryCeilingTest(const TCHAR * Params)
+	{
+		UE_LOG(LogT3DParserTests, Display, TEXT("Memory ceiling"));
+
+		int32 LevelMB = 4096;
+		int32 CeilingMB = 256;
+		FParse::Value(Params, TEXT("MemoryTestMB="), LevelMB);
+		FParse::Value(Params, TEXT("MemoryCeilingMB="), CeilingMB);
+		const int64 LevelBytes = (int64)LevelMB * 1024 * 1024;
+		const int64 CeilingBytes = (int64)CeilingMB * 1024 * 1024;
+
+		// A sample level gives the size of the actors, the test level is scaled from it
+		const FString Directory = TestDirectory() / TEXT("MemoryCeiling");
+		T3DCorpusGenerator::FSettings Settings;
+		Settings.Materials = 0;
+		Settings.MaterialInstanceConstants = 0;
+		T3DCorpusGenerator Sample(Settings);
+		if (!T3D_CHECK(Sample.Generate(Directory)) || !T3D_CHECK(Sample.GetGeneratedBytes() > 0))
+			return;
+
+		const double Scale = (double)LevelBytes / Sample.GetGeneratedBytes();
+		Settings.StaticMeshActors = (int32)FMath::Min(Settings.StaticMeshActors * Scale, (double)MAX_int32);
+		Settings.Brushes = (int32)FMath::Min(Settings.Brushes * Scale, (double)MAX_int32);
+		Settings.PointLights = (int32)FMath::Min(Settings.PointLights * Scale, (double)MAX_int32);
+		Settings.SpotLights = (int32)FMath::Min(Settings.SpotLights * Scale, (double)MAX_int32);
+
+		T3DCorpusGenerator Generator(Settings);
+		const FString LevelFileName = Directory / TEXT("PersistentLevel.T3D");
+		const bool bGenerated = Generator.Generate(Directory);
+		const int64 FileSize = IFileManager::Get().FileSize(*LevelFileName);
+		UE_LOG(LogT3DParserTests, Display, TEXT("Level: %s, %.2f GB"), *LevelFileName, FileSize / (1024.0 * 1024.0 * 1024.0));
+
+		// The level must be much larger than what may be resident, or the test proves nothing
+		if (T3D_CHECK(bGenerated) && T3D_CHECK(FileSize >= 4 * CeilingBytes))
+		{
+			// Actor blocks are streamed and dropped in batches, like T3DLevelParser::ImportLevel does, with the cache written on the way
+			const FString CacheFileName = T3DLineCache::CacheFileNameFor(LevelFileName);
+			IFileManager::Get().Delete(*CacheFileName);
+			const int64 Baseline = UsedPhysical();
+			int64 Peak = Baseline;
+			int64 Actors = 0;
+			int64 LargestBlock = 0;
+			int32 Lines = 0;
+			{
+				T3DReader Reader;
+				if (T3D_CHECK(Reader.ResetParserFromFile(LevelFileName, true)) && T3D_CHECK(Reader.NextLine()))
+				{
+					FString Class;
+					TArray<FString> Blocks;
+					int32 BlocksSize = 0;
+					while (Reader.NextLine() && !Reader.IsEndObject())
+					{
+						if (!Reader.IsBeginObject(Class))
+							continue;
+
+						FString &Block = Blocks.AddDefaulted_GetRef();
+						Reader.ReadBlock(Block);
+						T3D_CHECK(Block.EndsWith(TEXT("End Object"), ESearchCase::CaseSensitive));
+
+						LargestBlock = FMath::Max<int64>(LargestBlock, Block.GetAllocatedSize());
+						BlocksSize += Block.Len();
+						if (BlocksSize >= ActorBatchSize)
+						{
+							Peak = FMath::Max(Peak, UsedPhysical());
+							Actors += Blocks.Num();
+							Blocks.Reset();
+							BlocksSize = 0;
+						}
+					}
+					Peak = FMath::Max(Peak, UsedPhysical());
+					Actors += Blocks.Num();
+
+					Reader.FinishDocument();
+					Peak = FMath::Max(Peak, UsedPhysical());
+				}
+				Lines = Reader.LineIndex;
+			}
+
+			// A batch holds at most ActorBatchSize characters and one more block, the rest is the readers' fixed buffers
+			const int64 BlockBound = 2 * ((int64)ActorBatchSize * sizeof(TCHAR) + LargestBlock) + ReaderBuffersSize;
+			UE_LOG(LogT3DParserTests, Display, TEXT("Streamed %lld actors, %d lines, largest actor %.2f KB, resident memory grew by %.2f MB (bound %.2f MB, ceiling %d MB)"),
+				Actors, Lines, LargestBlock / 1024.0, (Peak - Baseline) / (1024.0 * 1024.0), BlockBound / (1024.0 * 1024.0), CeilingMB);
+			T3D_CHECK(Actors >= Settings.StaticMeshActors);
+			T3D_CHECK(Peak - Baseline < BlockBound);
+			T3D_CHECK(Peak - Baseline < CeilingBytes);
+			T3D_CHECK(IFileManager::Get().FileSize(*CacheFileName) > 0);
+		}
+
+		IFileManager::Get().DeleteDirectory(*Directory, false, true);
+	}
+}
@@ -0,0 +1,65 @@
+#include "T3DParserTests.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+#include "RequiredProgramMainCPPInclude.h"
+
+DEFINE_LOG_CATEGORY(LogT3DParserTests);
+
+IMPLEMENT_APPLICATION(T3DParserTests, "T3DParserTests");
+
+static int32 Failures = 0;
+
+bool T3DTests::Check(bool Condition, const TCHAR * Expression, const ANSICHAR * File, int32 Line)
+{
+	if (!Condition)
+	{
+		++Failures;
+		UE_LOG(LogT3DParserTests, Error, TEXT("%s(%d): check failed: %s"), ANSI_TO_TCHAR(File), Line, Expression);
+	}
+	return Condition;
+}
+
+FString T3DTests::TestDirectory()
+{
+	return FPaths::ConvertRelativePathToFull(FPlatformProcess::UserTempDir()) / TEXT("T3DParserTests");
+}
+
+/**
+* Usage: T3DParserTests [-NoUnitTests] [-NoThroughput] [-NoMemoryTest] [Actors=] [Brushes=] [Polygons=] [Lights=] [Components=] [Seed=] [MemoryTestMB=] [MemoryCeilingMB=]
+* Returns 0 if every check passed.
+*/
+INT32_MAIN_INT32_ARGC_TCHAR_ARGV()
+{
+	GEngineLoop.PreInit(ArgC, ArgV);
+
+	const TCHAR * Params = FCommandLine::Get();
+	if (!FParse::Param(Params, TEXT("NoUnitTests")))
+	{
+		T3DTests::RunLineReaderTests();
+		T3DTests::RunTokenizerTests();
+		T3DTests::RunNavigationTests();
+		T3DTests::RunNumberParserTests();
+	}
+
+	if (!FParse::Param(Params, TEXT("NoThroughput")))
+	{
+		T3DTests::RunThroughputTests(Params);
+	}
+
+	if (!FParse::Param(Params, TEXT("NoMemoryTest")))
+	{
+		T3DTests::RunMemoryCeilingTest(Params);
+	}
+
+	IFileManager::Get().DeleteDirectory(*T3DTests::TestDirectory(), false, true);
+
+	if (Failures > 0)
+		UE_LOG(LogT3DParserTests, Error, TEXT("%d checks failed"), Failures);
+	else
+		UE_LOG(LogT3DParserTests, Display, TEXT("All checks passed"));
+
+	FEngineLoop::AppExit();
+	return Failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogT3DParserTests, Log, All);
+
+/**
+* Headless tests and throughput benchmarks of the Core-only parser modules.
+* Failed checks are logged and counted, the program returns an error if any check failed.
+*/
+namespace T3DTests
+{
+	/** Logs Expression if Condition is false and counts the failure, returns Condition */
+	bool Check(bool Condition, const TCHAR * Expression, const ANSICHAR * File, int32 Line);
+
+	/** Directory of the files written by the tests, deleted on exit */
+	FString TestDirectory();
+
+	/// Unit tests
+	void RunLineReaderTests();
+	void RunTokenizerTests();
+	void RunNavigationTests();
+	void RunNumberParserTests();
+
+	/// Throughput benchmarks, over a corpus generated from the command line settings
+	void RunThroughputTests(const TCHAR * Params);
+
+	/// Streams a multi-gigabyte level and checks that resident memory stays under a ceiling
+	void RunMemoryCeilingTest(const TCHAR * Params);
+}
+
+#define T3D_CHECK(Condition) T3DTests::Check(!!(Condition), TEXT(#Condition), __FILE__, __LINE__)
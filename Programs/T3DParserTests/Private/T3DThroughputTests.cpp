@@ -0,0 +1,159 @@
+#include "T3DParserTests.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "T3DCorpusGenerator.h"
+#include "T3DLineCache.h"
+#include "T3DReader.h"
+
+namespace T3DTests
+{
+	/** Runs Body, which returns the number of lines it parsed, and logs its throughput */
+	static int64 RunPhase(const TCHAR * Name, int64 Bytes, TFunctionRef<int64()> Body)
+	{
+		const FPlatformMemoryStats Before = FPlatformMemory::GetStats();
+		const double Start = FPlatformTime::Seconds();
+		const int64 Lines = Body();
+		const double Seconds = FMath::Max(FPlatformTime::Seconds() - Start, 1e-9);
+		const FPlatformMemoryStats After = FPlatformMemory::GetStats();
+
+		UE_LOG(LogT3DParserTests, Display, TEXT("%-20s %8.3f s %10lld lines %12.0f lines/s %8.2f MB/s, memory %+8.2f MB, peak RSS %8.2f MB"),
+			Name, Seconds, Lines, Lines / Seconds, Bytes / Seconds / (1024.0 * 1024.0),
+			((int64)After.UsedPhysical - (int64)Before.UsedPhysical) / (1024.0 * 1024.0), After.PeakUsedPhysical / (1024.0 * 1024.0));
+		return Lines;
+	}
+
+	static int64 ReadLines(T3DLineReader &Reader)
+	{
+		FStringView Line;
+		int64 Lines = 0;
+		while (Reader.ReadLine(Line))
+		{
+			++Lines;
+		}
+		return Lines;
+	}
+
+	static int64 ReadLines(const FString &FileName, bool bStreamed, bool bUseCache)
+	{
+		T3DReader Reader;
+		Reader.bUseCache = bUseCache;
+		if (!Reader.ResetParserFromFile(FileName, bStreamed))
+			return 0;
+
+		while (Reader.NextLine())
+		{
+		}
+		return Reader.LineIndex;
+	}
+
+	/** Skips every actor block of the level, line by line or from the cached block table */
+	static int64 SkipActors(const FString &FileName, bool bUseCache)
+	{
+		T3DReader Reader;
+		Reader.bUseCache = bUseCache;
+
+		// The level is the first block, actors are the blocks it holds
+		if (!Reader.ResetParserFromFile(FileName) || !Reader.NextLine())
+			return 0;
+
+		while (Reader.NextLine())
+		{
+			if (Reader.Line.StartsWith(TEXT("Begin Object "), ESearchCase::CaseSensitive))
+				Reader.JumpToEnd();
+		}
+		return Reader.LineIndex;
+	}
+
+	/** Reads the values of the actor properties the importer looks up, returns the number of lines */
+	static int64 ParseValues(const FString &FileName, int64 &Values)
+	{
+		T3DReader Reader;
+		Reader.bUseCache = false;
+		if (!Reader.ResetParserFromFile(FileName))
+			return 0;
+
+		FVector Vector;
+		FRotator Rotator;
+		FColor Color;
+		float Float;
+		FString Value;
+		Values = 0;
+		while (Reader.NextLine())
+		{
+			if (Reader.GetProperty(TEXT("Location"), Vector)
+				|| Reader.GetProperty(TEXT("DrawScale3D"), Vector)
+				|| Reader.GetProperty(TEXT("PrePivot"), Vector)
+				|| Reader.GetProperty(TEXT("Rotation"), Rotator)
+				|| Reader.GetProperty(TEXT("LightColor"), Color)
+				|| Reader.GetProperty(TEXT("DrawScale"), Float)
+				|| Reader.GetProperty(TEXT("StaticMesh"), Value))
+			{
+				++Values;
+			}
+		}
+		return Reader.LineIndex;
+	}
+
+	void RunThroughputTests(const TCHAR * Params)
+	{
+		UE_LOG(LogT3DParserTests, Display, TEXT("Throughput"));
+
+		// Only the level is measured here, materials need the editor parsers
+		T3DCorpusGenerator::FSettings Settings;
+		Settings.Materials = 0;
+		Settings.MaterialInstanceConstants = 0;
+		FParse::Value(Params, TEXT("Actors="), Settings.StaticMeshActors);
+		FParse::Value(Params, TEXT("Brushes="), Settings.Brushes);
+		FParse::Value(Params, TEXT("Polygons="), Settings.PolygonsPerBrush);
+		FParse::Value(Params, TEXT("Components="), Settings.NestedComponents);
+		FParse::Value(Params, TEXT("Seed="), Settings.Seed);
+
+		int32 Lights;
+		if (FParse::Value(Params, TEXT("Lights="), Lights))
+		{
+			Settings.PointLights = Lights / 2;
+			Settings.SpotLights = Lights - Settings.PointLights;
+		}
+
+		const FString Directory = TestDirectory() / TEXT("Corpus");
+		T3DCorpusGenerator Generator(Settings);
+		RunPhase(TEXT("Generate"), 0, [&]()
+		{
+			return Generator.Generate(Directory) ? 0 : -1;
+		});
+
+		const FString LevelFileName = Directory / TEXT("PersistentLevel.T3D");
+		const int64 LevelBytes = IFileManager::Get().FileSize(*LevelFileName);
+		if (!T3D_CHECK(LevelBytes > 0))
+			return;
+
+		const int64 Lines = RunPhase(TEXT("Lines, string"), LevelBytes, [&]()
+		{
+			FString Content;
+			if (!FFileHelper::LoadFileToString(Content, *LevelFileName))
+				return (int64)0;
+
+			T3DStringLineReader Reader(MoveTemp(Content));
+			return ReadLines(Reader);
+		});
+		T3D_CHECK(Lines > 0);
+
+		// Every reader hands out the same lines
+		T3D_CHECK(RunPhase(TEXT("Lines, mapped"), LevelBytes, [&]() { return ReadLines(LevelFileName, false, false); }) == Lines);
+		T3D_CHECK(RunPhase(TEXT("Lines, stream"), LevelBytes, [&]() { return ReadLines(LevelFileName, true, false); }) == Lines);
+		IFileManager::Get().Delete(*T3DLineCache::CacheFileNameFor(LevelFileName));
+		T3D_CHECK(RunPhase(TEXT("Lines, to cache"), LevelBytes, [&]() { return ReadLines(LevelFileName, false, true); }) == Lines);
+		T3D_CHECK(RunPhase(TEXT("Lines, cached"), LevelBytes, [&]() { return ReadLines(LevelFileName, false, true); }) == Lines);
+
+		T3D_CHECK(RunPhase(TEXT("Actors, skipped"), LevelBytes, [&]() { return SkipActors(LevelFileName, false); }) == Lines);
+		T3D_CHECK(RunPhase(TEXT("Actors, cached"), LevelBytes, [&]() { return SkipActors(LevelFileName, true); }) == Lines);
+
+		int64 Values = 0;
+		RunPhase(TEXT("Values"), LevelBytes, [&]() { return ParseValues(LevelFileName, Values); });
+		UE_LOG(LogT3DParserTests, Display, TEXT("Values: %lld properties parsed"), Values);
+		T3D_CHECK(Values >= Settings.StaticMeshActors);
+	}
+}
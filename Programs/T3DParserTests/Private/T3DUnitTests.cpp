@@ -0,0 +1,390 @@
+#include "T3DParserTests.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "T3DLineCache.h"
+#include "T3DLineReader.h"
+#include "T3DNumberParser.h"
+#include "T3DReader.h"
+
+namespace T3DTests
+{
+	/// Line readers
+
+	/** Length of the long line of the reader document, longer than a stream chunk and than a mapped window */
+	static const int32 LongLineLen = 20 * 1024 * 1024;
+
+	/** Number of empty lines in a row in the reader document, more than a stream chunk holds */
+	static const int32 EmptyLinesLen = 2 * 1024 * 1024;
+
+	/** Document with the kinds of lines the readers must handle, Expected receives its lines as they must be handed out */
+	static FString MakeReaderDocument(TArray<FString> &Expected)
+	{
+		const FString LongLine = FString(TEXT("LongValue=")) + FString::ChrN(LongLineLen, TCHAR('A'));
+
+		Expected.Reset();
+		Expected.Add(TEXT("Begin Map"));
+		Expected.Add(TEXT("Begin Level NAME=PersistentLevel"));
+		Expected.Add(TEXT("Begin Actor Class=StaticMeshActor Name=StaticMeshActor_0"));
+		Expected.Add(TEXT("Tag=\"Caf\u00E9\""));
+		Expected.Add(TEXT("Location=(X=1.000000,Y=-2.500000,Z=3.000000)"));
+		Expected.Add(LongLine);
+		Expected.Add(TEXT("End Actor"));
+		Expected.Add(TEXT("End Level"));
+		Expected.Add(TEXT("End Map"));
+
+		// Indents, CR and trailing spaces are trimmed, empty lines are culled, even across chunks, the last line has no line feed
+		FString Document;
+		Document += TEXT("\n\nBegin Map\r\n\n");
+		Document += TEXT("   Begin Level NAME=PersistentLevel\r\n");
+		Document += TEXT("\t\tBegin Actor Class=StaticMeshActor Name=StaticMeshActor_0\n");
+		Document += TEXT("      Tag=\"Caf\u00E9\"   \n\n\n");
+		Document += TEXT("      Location=(X=1.000000,Y=-2.500000,Z=3.000000)\r\n");
+		Document += FString::ChrN(EmptyLinesLen, TCHAR('\n'));
+		Document += TEXT("      ") + LongLine + TEXT("\r\n");
+		Document += TEXT("\t\tEnd Actor\r\n");
+		Document += TEXT("   End Level\r\n");
+		Document += TEXT("End Map");
+		return Document;
+	}
+
+	/** Reads every line of Reader and compares them with Expected */
+	static void CheckLines(T3DLineReader &Reader, const TArray<FString> &Expected)
+	{
+		FStringView Line;
+		int32 Index = 0;
+		while (Reader.ReadLine(Line))
+		{
+			if (!T3D_CHECK(Index < Expected.Num()))
+				return;
+
+			T3D_CHECK(Line.Equals(*Expected[Index], ESearchCase::CaseSensitive));
+			T3D_CHECK(Line.GetData()[Line.Len()] == TCHAR('\0'));
+			++Index;
+		}
+		T3D_CHECK(Index == Expected.Num());
+	}
+
+	/** Moves to the actor of the reader document and skips it, returns the index of its End line */
+	static int32 SkipActor(T3DReader &Reader)
+	{
+		while (Reader.NextLine() && !Reader.Line.StartsWith(TEXT("Begin Actor ")))
+		{
+		}
+
+		Reader.JumpToEnd();
+		T3D_CHECK(Reader.Line.Equals(TEXT("End Actor"), ESearchCase::CaseSensitive));
+		return Reader.LineIndex;
+	}
+
+	void RunLineReaderTests()
+	{
+		UE_LOG(LogT3DParserTests, Display, TEXT("Line readers"));
+
+		TArray<FString> Expected;
+		const FString Document = MakeReaderDocument(Expected);
+		const FString FileName = TestDirectory() / TEXT("Lines.T3D");
+		const FString BOMFileName = TestDirectory() / TEXT("LinesBOM.T3D");
+		const FString UTF16FileName = TestDirectory() / TEXT("LinesUTF16.T3D");
+		T3D_CHECK(FFileHelper::SaveStringToFile(Document, *FileName, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM));
+		T3D_CHECK(FFileHelper::SaveStringToFile(Document, *BOMFileName, FFileHelper::EEncodingOptions::ForceUTF8));
+		T3D_CHECK(FFileHelper::SaveStringToFile(Document, *UTF16FileName, FFileHelper::EEncodingOptions::ForceUnicode));
+
+		{
+			T3DStringLineReader Reader(FString(Document));
+			CheckLines(Reader, Expected);
+		}
+
+		const TArray<FString> FileNames = { FileName, BOMFileName };
+		for (const FString &Name : FileNames)
+		{
+			TUniquePtr<T3DMappedLineReader> Mapped = T3DMappedLineReader::Open(Name);
+			if (T3D_CHECK(Mapped.IsValid()))
+				CheckLines(*Mapped, Expected);
+
+			TUniquePtr<T3DStreamLineReader> Stream = T3DStreamLineReader::Open(Name);
+			if (T3D_CHECK(Stream.IsValid()))
+				CheckLines(*Stream, Expected);
+		}
+
+		// UTF-16 documents are loaded as a whole
+		T3D_CHECK(!T3DMappedLineReader::Open(UTF16FileName).IsValid());
+		T3D_CHECK(!T3DStreamLineReader::Open(UTF16FileName).IsValid());
+		{
+			T3DReader Reader;
+			Reader.bUseCache = false;
+			if (T3D_CHECK(Reader.ResetParserFromFile(UTF16FileName)))
+				CheckLines(*Reader.Reader, Expected);
+		}
+
+		// A cache abandoned before the end of the document is discarded
+		const FString CacheFileName = T3DLineCache::CacheFileNameFor(FileName);
+		IFileManager::Get().Delete(*CacheFileName);
+		{
+			T3DReader Reader;
+			T3D_CHECK(Reader.ResetParserFromFile(FileName) && SkipActor(Reader) == 7);
+		}
+		{
+			TArray<FString> Scanned;
+			IFileManager::Get().FindFiles(Scanned, *(TestDirectory() / TEXT("Lines.*")), true, false);
+			T3D_CHECK(Scanned.Num() == 1);
+		}
+
+		// The first full read writes the cache, the export folder scan must not take the cache being written for an exported file
+		{
+			T3DReader Reader;
+			if (T3D_CHECK(Reader.ResetParserFromFile(FileName)) && T3D_CHECK(Reader.NextLine()))
+			{
+				TArray<FString> Scanned;
+				IFileManager::Get().FindFiles(Scanned, *(TestDirectory() / TEXT("*")), true, false);
+				for (const FString &Name : Scanned)
+				{
+					T3D_CHECK(!Name.MatchesWildcard(TEXT("*.???")) || Name.EndsWith(TEXT(".T3D")));
+				}
+				Reader.FinishDocument();
+				T3D_CHECK(Reader.LineIndex == Expected.Num());
+			}
+		}
+		T3D_CHECK(IFileManager::Get().FileSize(*CacheFileName) > 0);
+
+		TUniquePtr<T3DCachedLineReader> Cached = T3DCachedLineReader::Open(FileName, IFileManager::Get().GetStatData(*FileName));
+		if (T3D_CHECK(Cached.IsValid()))
+			CheckLines(*Cached, Expected);
+
+		// Stored tokens are the ones of the tokenizer
+		Cached = T3DCachedLineReader::Open(FileName, IFileManager::Get().GetStatData(*FileName));
+		if (T3D_CHECK(Cached.IsValid()))
+		{
+			FStringView Line;
+			while (Cached->ReadLine(Line))
+			{
+				FT3DLineTokens Stored, Tokens;
+				T3D_CHECK(Cached->GetLineTokens(Stored));
+				T3DReader::TokenizeLine(Line, Tokens);
+				T3D_CHECK(Stored.KeyLen == Tokens.KeyLen && Stored.NameLen == Tokens.NameLen
+					&& Stored.ValueStart == Tokens.ValueStart && Stored.ValueLen == Tokens.ValueLen
+					&& Stored.bNested == Tokens.bNested && Stored.bQuoted == Tokens.bQuoted);
+			}
+		}
+		Cached.Reset();
+
+		// Blocks skipped from the cached table end on the same line as blocks skipped line by line
+		{
+			T3DReader Reader, CachedReader;
+			Reader.bUseCache = false;
+			T3D_CHECK(Reader.ResetParserFromFile(FileName));
+			T3D_CHECK(CachedReader.ResetParserFromFile(FileName));
+			T3D_CHECK(SkipActor(Reader) == 7);
+			T3D_CHECK(SkipActor(CachedReader) == 7);
+			T3D_CHECK(CachedReader.NextLine() && CachedReader.Line.Equals(TEXT("End Level"), ESearchCase::CaseSensitive));
+		}
+
+		// A cache built from another version of the document is ignored
+		IFileManager::Get().SetTimeStamp(*FileName, FDateTime(2000, 1, 1));
+		T3D_CHECK(!T3DCachedLineReader::Open(FileName, IFileManager::Get().GetStatData(*FileName)).IsValid());
+	}
+
+	/// Tokenizer
+
+	struct FTokenCase
+	{
+		const TCHAR * Line;
+		const TCHAR * Key; // Empty if the line is not a property
+		const TCHAR * Name;
+		const TCHAR * Value;
+		bool bNested;
+		bool bQuoted;
+	};
+
+	static const FTokenCase TokenCases[] =
+	{
+		{ TEXT("Location=(X=1,Y=2,Z=3)"), TEXT("Location"), TEXT("Location"), TEXT("(X=1,Y=2,Z=3)"), true, false },
+		{ TEXT("Nested=(A=(B=1),C=2) Extra"), TEXT("Nested"), TEXT("Nested"), TEXT("(A=(B=1),C=2)"), true, false },
+		{ TEXT("Tag=\"A \\\"B\\\"\""), TEXT("Tag"), TEXT("Tag"), TEXT("A \\\"B\\\""), false, true },
+		{ TEXT("Materials(0)=Material'Pkg.Mat'"), TEXT("Materials(0)"), TEXT("Materials"), TEXT("Material'Pkg.Mat'"), false, false },
+		{ TEXT("Func(a b)=1"), TEXT("Func(a b)"), TEXT("Func(a b)"), TEXT("1"), false, false },
+		{ TEXT("Begin Object Class=StaticMeshActor Name=A"), TEXT("Begin Object Class"), TEXT("Begin Object Class"), TEXT("StaticMeshActor"), false, false },
+		{ TEXT("Empty="), TEXT("Empty"), TEXT("Empty"), TEXT(""), false, false },
+		{ TEXT("End Object"), TEXT(""), TEXT(""), TEXT(""), false, false },
+		{ TEXT("=Value"), TEXT(""), TEXT(""), TEXT(""), false, false },
+	};
+
+	void RunTokenizerTests()
+	{
+		UE_LOG(LogT3DParserTests, Display, TEXT("Tokenizer"));
+
+		for (const FTokenCase &Case : TokenCases)
+		{
+			FT3DLineTokens Tokens;
+			T3DReader::TokenizeLine(FStringView(Case.Line), Tokens);
+			if (*Case.Key == 0)
+			{
+				T3D_CHECK(Tokens.KeyLen == 0);
+				continue;
+			}
+
+			T3D_CHECK(FStringView(Case.Line, Tokens.KeyLen).Equals(Case.Key, ESearchCase::CaseSensitive));
+			T3D_CHECK(FStringView(Case.Line, Tokens.NameLen).Equals(Case.Name, ESearchCase::CaseSensitive));
+			T3D_CHECK(FStringView(Case.Line + Tokens.ValueStart, Tokens.ValueLen).Equals(Case.Value, ESearchCase::CaseSensitive));
+			T3D_CHECK(Tokens.bNested == Case.bNested);
+			T3D_CHECK(Tokens.bQuoted == Case.bQuoted);
+		}
+	}
+
+	/// Navigation and values
+
+	static const TCHAR * const NavigationDocument =
+		TEXT("Begin Object Class=StaticMeshActor Name=StaticMeshActor_12\n")
+		TEXT("   Begin Object Class=StaticMeshComponent Name=StaticMeshComponent0\n")
+		TEXT("      StaticMesh=StaticMesh'Pkg.Group.Mesh'\n")
+		TEXT("   End Object\n")
+		TEXT("   Begin Object Class=LightComponent Name=Light0\n")
+		TEXT("      Begin Object Class=Other Name=Nested\n")
+		TEXT("      End Object\n")
+		TEXT("   End Object\n")
+		TEXT("   Begin Brush Name=Model_1\n")
+		TEXT("      Begin PolyList\n")
+		TEXT("      End PolyList\n")
+		TEXT("   End Brush\n")
+		TEXT("   Location=(X=1.5,Y=-2,Z=3e2)\n")
+		TEXT("   Rotation=(Pitch=16384,Yaw=-32768,Roll=0)\n")
+		TEXT("   DrawScale=0.5\n")
+		TEXT("   LightColor=(B=10,G=20,R=30,A=255)\n")
+		TEXT("   Materials(1)=Material'Pkg.Mat'\n")
+		TEXT("   Tag=\"Quoted \\\"value\\\"\"\n")
+		TEXT("End Object\n");
+
+	void RunNavigationTests()
+	{
+		UE_LOG(LogT3DParserTests, Display, TEXT("Navigation"));
+
+		T3DReader Reader;
+		FString Class, Value, Type, Package, Name;
+		Reader.ResetParser(NavigationDocument);
+
+		T3D_CHECK(Reader.NextLine() && Reader.IsBeginObject(Class) && Class == TEXT("StaticMeshActor"));
+		T3D_CHECK(Reader.GetOneValueAfter(TEXT(" Name="), Value) && Value == TEXT("StaticMeshActor_12"));
+		T3D_CHECK(!Reader.GetOneValueAfter(TEXT(" Name="), Value, 10));
+
+		// Sub objects, nested ones included
+		T3D_CHECK(Reader.NextLine() && Reader.IsBeginObject(Class) && Class == TEXT("StaticMeshComponent"));
+		Reader.JumpToEnd();
+		T3D_CHECK(Reader.IsEndObject() && Reader.LineIndex == 4);
+		T3D_CHECK(Reader.NextLine() && Reader.IgnoreSubObjects());
+		T3D_CHECK(Reader.Line.StartsWith(TEXT("Begin Brush ")) && Reader.LineIndex == 9);
+		T3D_CHECK(Reader.IgnoreSubs() && Reader.LineIndex == 13);
+
+		// Values
+		FVector Vector;
+		T3D_CHECK(!Reader.GetProperty(TEXT("Loc"), Vector));
+		T3D_CHECK(Reader.GetProperty(TEXT("Location"), Vector) && Vector == FVector(1.5f, -2.f, 300.f));
+
+		FRotator Rotator;
+		T3D_CHECK(Reader.NextLine() && Reader.GetProperty(TEXT("Rotation"), Rotator));
+		T3D_CHECK(Rotator == FRotator(16384 * T3DReader::UnrRotToDeg, -32768 * T3DReader::UnrRotToDeg, 0.f));
+
+		float Scale;
+		T3D_CHECK(Reader.NextLine() && Reader.GetProperty(TEXT("DrawScale"), Scale) && Scale == 0.5f);
+
+		FColor Color;
+		T3D_CHECK(Reader.NextLine() && Reader.GetProperty(TEXT("LightColor"), Color) && Color == FColor(30, 20, 10, 255));
+
+		int32 Index;
+		T3D_CHECK(Reader.NextLine() && Reader.IsParameter(TEXT("Materials"), Index, Value) && Index == 1 && Value == TEXT("Material'Pkg.Mat'"));
+		T3D_CHECK(Reader.ParseResourceUrl(Value, Type, Package, Name) && Type == TEXT("Material") && Package == TEXT("Pkg") && Name == TEXT("Mat"));
+
+		T3D_CHECK(Reader.NextLine() && Reader.IsProperty(Name, Value) && Name == TEXT("Tag") && Value == TEXT("Quoted \\\"value\\\""));
+		T3D_CHECK(Reader.LineProperty.bQuoted && !Reader.LineProperty.bNested);
+
+		T3D_CHECK(Reader.NextLine() && Reader.IsEndObject() && Reader.LineIndex == 19);
+		T3D_CHECK(!Reader.NextLine());
+
+		// Blocks read as a whole keep their lines trimmed
+		FString Block;
+		Reader.ResetParser(NavigationDocument);
+		T3D_CHECK(Reader.NextLine());
+		Reader.ReadBlock(Block);
+		T3D_CHECK(Block.StartsWith(TEXT("Begin Object Class=StaticMeshActor Name=StaticMeshActor_12\nBegin Object ")) && Block.EndsWith(TEXT("\nEnd Object")));
+		T3D_CHECK(Reader.LineIndex == 19);
+
+		// Resource urls
+		Reader.ParseResourceUrl(TEXT("Pkg.Group.Mesh"), Package, Name);
+		T3D_CHECK(Package == TEXT("Pkg") && Name == TEXT("Mesh"));
+		Reader.ParseResourceUrl(TEXT("Mesh"), Package, Name);
+		T3D_CHECK(Package == TEXT("Mesh") && Name.IsEmpty());
+
+		Reader.Package = TEXT("Current");
+		T3D_CHECK(Reader.ParseResourceUrl(TEXT("Texture2D'Tex'"), Type, Package, Name) && Type == TEXT("Texture2D") && Package == TEXT("Current") && Name == TEXT("Tex"));
+		T3D_CHECK(Reader.ParseResourceUrl(TEXT("StaticMesh'Pkg.Group.Mesh'"), Type, Package, Name) && Package == TEXT("Pkg") && Name == TEXT("Mesh"));
+		T3D_CHECK(!Reader.ParseResourceUrl(TEXT("Texture2D"), Type, Package, Name));
+	}
+
+	/// Numbers
+
+	struct FNumberCase
+	{
+		const TCHAR * Text;
+		bool bValid;
+		double Value;
+		int32 Consumed;
+	};
+
+	static const FNumberCase NumberCases[] =
+	{
+		{ TEXT("1.5"), true, 1.5, 3 },
+		{ TEXT("-2,"), true, -2.0, 2 },
+		{ TEXT("+3e2"), true, 300.0, 4 },
+		{ TEXT(".25)"), true, 0.25, 3 },
+		{ TEXT("  7"), true, 7.0, 3 },
+		{ TEXT("0.1"), true, 0.1, 3 },
+		{ TEXT("-00002.500000"), true, -2.5, 13 },
+		{ TEXT("1e"), true, 1.0, 1 },
+		{ TEXT("12345678901234567890123"), true, 12345678901234567890123.0, 23 },
+		{ TEXT("abc"), false, 0.0, 0 },
+		{ TEXT("-"), false, 0.0, 0 },
+	};
+
+	void RunNumberParserTests()
+	{
+		UE_LOG(LogT3DParserTests, Display, TEXT("Number parser"));
+
+		for (const FNumberCase &Case : NumberCases)
+		{
+			const TCHAR * Stream = Case.Text;
+			double Value = 0.0;
+			T3D_CHECK(T3DNumberParser::ParseNumber(Stream, Value) == Case.bValid);
+			T3D_CHECK(Value == Case.Value && Stream - Case.Text == Case.Consumed);
+		}
+
+		// Same results as the engine parsing of the original importer
+		static const TCHAR * const Vectors[] =
+		{
+			TEXT("(X=1.000000,Y=-2.500000,Z=3.000000)"),
+			TEXT("(X=0.1,Y=1e3,Z=-.5)"),
+			TEXT("(Z=1,X=2,Y=3)"),
+			TEXT("(X=1,Y=2)"),
+		};
+		for (const TCHAR * Text : Vectors)
+		{
+			FVector Expected, Vector;
+			const bool bExpected = Expected.InitFromString(Text);
+			T3D_CHECK(T3DNumberParser::ParseVector(Text, Vector) == bExpected && Vector == Expected);
+		}
+
+		FColor Color;
+		T3D_CHECK(T3DNumberParser::ParseColor(TEXT("(B=10,G=20,R=30,A=128)"), Color) && Color == FColor(30, 20, 10, 128));
+		T3D_CHECK(T3DNumberParser::ParseColor(TEXT("(R=1,G=2,B=3)"), Color) && Color == FColor(1, 2, 3, 255));
+
+		FLinearColor LinearColor;
+		T3D_CHECK(T3DNumberParser::ParseLinearColor(TEXT("(R=0.5,G=0.25,B=1.0,A=0.75)"), LinearColor) && LinearColor == FLinearColor(0.5f, 0.25f, 1.f, 0.75f));
+
+		FVector Triple;
+		T3D_CHECK(T3DNumberParser::ParseTriple(TEXT("+00001.500000,-00002.000000,+00300.000000"), Triple) && Triple == FVector(1.5f, -2.f, 300.f));
+		T3D_CHECK(!T3DNumberParser::ParseTriple(TEXT("1,2"), Triple) && Triple == FVector(1.f, 2.f, 0.f));
+
+		T3DReader Reader;
+		FRotator Rotator;
+		T3D_CHECK(Reader.ParseUDKRotation(TEXT("(Pitch=16384,Yaw=-32768,Roll=0)"), Rotator));
+		T3D_CHECK(!Reader.ParseUDKRotation(TEXT("(Pitch=1,Yaw=2)"), Rotator));
+	}
+}
@@ -0,0 +1,20 @@
+using UnrealBuildTool;
+using System.IO;
+
+public class T3DParserTests : ModuleRules
+{
+	public T3DParserTests(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PublicIncludePaths.Add(Path.Combine(EngineDirectory, "Source/Runtime/Launch/Public"));
+		PrivateIncludePaths.Add(Path.Combine(EngineDirectory, "Source/Runtime/Launch/Private"));
+
+		PrivateDependencyModuleNames.AddRange(
+			new string[] {
+				"Core",
+				"Projects",
+				"T3DParserCore",
+				"T3DCorpus"
+			}
+		);
+	}
+}
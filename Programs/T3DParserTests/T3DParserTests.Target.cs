@@ -0,0 +1,23 @@
+using UnrealBuildTool;
+
+[SupportedPlatforms(UnrealPlatformClass.Desktop)]
+public class T3DParserTestsTarget : TargetRules
+{
+	public T3DParserTestsTarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Program;
+		LinkType = TargetLinkType.Monolithic;
+		LaunchModuleName = "T3DParserTests";
+
+		// Headless, only Core and the Core-only modules of the plugin are built
+		bBuildDeveloperTools = true; // T3DCorpus is a Developer module
+		bBuildWithEditorOnlyData = true;
+		bCompileAgainstEngine = false;
+		bCompileAgainstCoreUObject = false;
+		bCompileAgainstApplicationCore = false;
+		bCompileICU = false;
+		bIsBuildingConsoleApplication = true;
+
+		EnablePlugins.Add("UDKImportPlugin");
+	}
+}
@@ -0,0 +1,274 @@
+#include "T3DCorpusGenerator.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+// Buffered text is written to the file once it reaches this size
+static const int32 FlushSize = 1024 * 1024;
+
+static const TCHAR * const CorpusPackage = TEXT("CorpusPackage");
+
+T3DCorpusGenerator::T3DCorpusGenerator(const FSettings &Settings)
+	: Settings(Settings), Random(Settings.Seed)
+{
+	GeneratedBytes = 0;
+}
+
+bool T3DCorpusGenerator::Generate(const FString &Directory)
+{
+	GeneratedBytes = 0;
+	Random.Initialize(Settings.Seed);
+
+	if (!WriteLevel(Directory / TEXT("PersistentLevel.T3D")))
+		return false;
+
+	for (int32 Index = 0; Index < Settings.Materials; ++Index)
+	{
+		if (!WriteMaterial(Directory / TEXT("ExportedMaterials") / FString::Printf(TEXT("Mat_%d.T3D"), Index), Index))
+			return false;
+	}
+
+	for (int32 Index = 0; Index < Settings.MaterialInstanceConstants; ++Index)
+	{
+		if (!WriteMaterialInstanceConstant(Directory / TEXT("ExportedMaterialInstances") / FString::Printf(TEXT("MIC_%d.T3D"), Index), Index))
+			return false;
+	}
+
+	return true;
+}
+
+bool T3DCorpusGenerator::WriteLevel(const FString &FileName)
+{
+	TUniquePtr<FArchive> Archive(IFileManager::Get().CreateFileWriter(*FileName));
+	if (!Archive.IsValid())
+		return false;
+
+	Buffer.Reset();
+	AddLine(TEXT(""), TEXT("Begin Object Class=Level Name=PersistentLevel"));
+
+	// Actors are interleaved like in real levels
+	const int32 Total = Settings.StaticMeshActors + Settings.Brushes + Settings.PointLights + Settings.SpotLights;
+	int32 StaticMeshActors = 0, Brushes = 0, PointLights = 0, SpotLights = 0;
+	for (int32 Index = 0; Index < Total; ++Index)
+	{
+		int32 Pick = Random.RandHelper(Total - Index);
+		if ((Pick -= Settings.StaticMeshActors - StaticMeshActors) < 0)
+			AddStaticMeshActor(StaticMeshActors++);
+		else if ((Pick -= Settings.Brushes - Brushes) < 0)
+			AddBrush(Brushes++);
+		else if ((Pick -= Settings.PointLights - PointLights) < 0)
+			AddLight(TEXT("PointLight"), TEXT("PointLightComponent"), PointLights++);
+		else
+			AddLight(TEXT("SpotLight"), TEXT("SpotLightComponent"), SpotLights++);
+
+		if (!Flush(Archive.Get()))
+			return false;
+	}
+
+	AddLine(TEXT(""), TEXT("End Object"));
+	return Flush(Archive.Get(), true) && Archive->Close();
+}
+
+bool T3DCorpusGenerator::WriteMaterial(const FString &FileName, int32 Index)
+{
+	TUniquePtr<FArchive> Archive(IFileManager::Get().CreateFileWriter(*FileName));
+	if (!Archive.IsValid())
+		return false;
+
+	Buffer.Reset();
+	AddLine(TEXT(""), FString::Printf(TEXT("Begin Object Class=Material Name=Mat_%d"), Index));
+
+	// A chain of texture samples multiplied by constants
+	TArray<FString> Expressions;
+	FString Previous;
+	for (int32 Expression = 0; Expression < Settings.ExpressionsPerMaterial; ++Expression)
+	{
+		FString Name;
+		if (Expression % 3 == 0)
+		{
+			Name = FString::Printf(TEXT("MaterialExpressionTextureSample_%d"), Expression);
+			AddLine(TEXT("   "), FString::Printf(TEXT("Begin Object Class=MaterialExpressionTextureSample Name=%s"), *Name));
+			AddLine(TEXT("      "), FString::Printf(TEXT("Texture=Texture2D'%s.Textures.Tex_%d'"), CorpusPackage, Random.RandHelper(FMath::Max(Settings.Materials, 1))));
+		}
+		else if (Expression % 3 == 1)
+		{
+			Name = FString::Printf(TEXT("MaterialExpressionConstant3Vector_%d"), Expression);
+			AddLine(TEXT("   "), FString::Printf(TEXT("Begin Object Class=MaterialExpressionConstant3Vector Name=%s"), *Name));
+			AddLine(TEXT("      "), FString::Printf(TEXT("R=%f"), Random.FRand()));
+			AddLine(TEXT("      "), FString::Printf(TEXT("G=%f"), Random.FRand()));
+			AddLine(TEXT("      "), FString::Printf(TEXT("B=%f"), Random.FRand()));
+		}
+		else
+		{
+			Name = FString::Printf(TEXT("MaterialExpressionMultiply_%d"), Expression);
+			AddLine(TEXT("   "), FString::Printf(TEXT("Begin Object Class=MaterialExpressionMultiply Name=%s"), *Name));
+			AddLine(TEXT("      "), FString::Printf(TEXT("A=(Expression=%s,Mask=1,MaskR=1,MaskG=1,MaskB=1)"), *Previous));
+			AddLine(TEXT("      "), FString::Printf(TEXT("B=(Expression=MaterialExpressionConstant3Vector'MaterialExpressionConstant3Vector_%d')"), Expression - 1));
+		}
+		AddLine(TEXT("      "), FString::Printf(TEXT("MaterialExpressionEditorX=%d"), -200 * (Expression + 1)));
+		AddLine(TEXT("      "), FString::Printf(TEXT("MaterialExpressionEditorY=%d"), 100 * (Expression % 5)));
+		AddLine(TEXT("      "), FString::Printf(TEXT("Name=\"%s\""), *Name));
+		AddLine(TEXT("   "), TEXT("End Object"));
+
+		Previous = FString::Printf(TEXT("%s'%s'"), *Name.Left(Name.Find(TEXT("_"), ESearchCase::CaseSensitive, ESearchDir::FromEnd)), *Name);
+		Expressions.Add(Previous);
+	}
+
+	if (Previous.Len() > 0)
+	{
+		AddLine(TEXT("   "), FString::Printf(TEXT("DiffuseColor=(Expression=%s,Mask=1,MaskR=1,MaskG=1,MaskB=1)"), *Previous));
+	}
+	for (int32 Expression = 0; Expression < Expressions.Num(); ++Expression)
+	{
+		AddLine(TEXT("   "), FString::Printf(TEXT("Expressions(%d)=%s"), Expression, *Expressions[Expression]));
+	}
+	AddLine(TEXT("   "), FString::Printf(TEXT("Name=\"Mat_%d\""), Index));
+	AddLine(TEXT(""), TEXT("End Object"));
+
+	return Flush(Archive.Get(), true) && Archive->Close();
+}
+
+bool T3DCorpusGenerator::WriteMaterialInstanceConstant(const FString &FileName, int32 Index)
+{
+	TUniquePtr<FArchive> Archive(IFileManager::Get().CreateFileWriter(*FileName));
+	if (!Archive.IsValid())
+		return false;
+
+	Buffer.Reset();
+	AddLine(TEXT(""), FString::Printf(TEXT("Begin Object Class=MaterialInstanceConstant Name=MIC_%d"), Index));
+	AddLine(TEXT("   "), FString::Printf(TEXT("Parent=Material'%s.Materials.Mat_%d'"), CorpusPackage, Random.RandHelper(FMath::Max(Settings.Materials, 1))));
+	AddLine(TEXT("   "), FString::Printf(TEXT("ScalarParameterValues(0)=(ParameterName=\"Roughness\",ParameterValue=%f,ExpressionGUID=00000000000000000000000000000000)"), Random.FRand()));
+	AddLine(TEXT("   "), FString::Printf(TEXT("TextureParameterValues(0)=(ParameterName=\"Diffuse\",ParameterValue=Texture2D'%s.Textures.Tex_%d',ExpressionGUID=00000000000000000000000000000000)"), CorpusPackage, Index));
+	AddLine(TEXT("   "), FString::Printf(TEXT("VectorParameterValues(0)=(ParameterName=\"Tint\",ParameterValue=(R=%f,G=%f,B=%f,A=1.000000),ExpressionGUID=00000000000000000000000000000000)"), Random.FRand(), Random.FRand(), Random.FRand()));
+	AddLine(TEXT("   "), FString::Printf(TEXT("Name=\"MIC_%d\""), Index));
+	AddLine(TEXT(""), TEXT("End Object"));
+
+	return Flush(Archive.Get(), true) && Archive->Close();
+}
+
+void T3DCorpusGenerator::AddStaticMeshActor(int32 Index)
+{
+	AddLine(TEXT("   "), FString::Printf(TEXT("Begin Object Class=StaticMeshActor Name=StaticMeshActor_%d Archetype=StaticMeshActor'Engine.Default__StaticMeshActor'"), Index));
+	AddLine(TEXT("      "), TEXT("Begin Object Class=StaticMeshComponent Name=StaticMeshComponent0 ObjectArchetype=StaticMeshComponent'Engine.Default__StaticMeshActor:StaticMeshComponent0'"));
+	AddLine(TEXT("         "), FString::Printf(TEXT("StaticMesh=StaticMesh'%s.Meshes.Mesh_%d'"), CorpusPackage, Random.RandHelper(FMath::Max(Settings.StaticMeshActors / 10, 1))));
+	AddLine(TEXT("         "), TEXT("ReplacementPrimitive=None"));
+	AddLine(TEXT("         "), TEXT("bAllowApproximateOcclusion=True"));
+	AddLine(TEXT("         "), TEXT("LightingChannels=(bInitialized=True,Static=True)"));
+	AddLine(TEXT("         "), TEXT("Name=\"StaticMeshComponent0\""));
+	AddLine(TEXT("      "), TEXT("End Object"));
+	AddNestedComponents(TEXT("      "));
+	AddLine(TEXT("      "), TEXT("StaticMeshComponent=StaticMeshComponent'StaticMeshComponent0'"));
+	AddLine(TEXT("      "), TEXT("Components(0)=StaticMeshComponent'StaticMeshComponent0'"));
+	AddLine(TEXT("      "), FString::Printf(TEXT("DrawScale=%f"), Random.FRandRange(0.5f, 2.0f)));
+	AddLine(TEXT("      "), FString::Printf(TEXT("DrawScale3D=(X=%f,Y=%f,Z=%f)"), Random.FRandRange(0.5f, 2.0f), Random.FRandRange(0.5f, 2.0f), Random.FRandRange(0.5f, 2.0f)));
+	AddLine(TEXT("      "), FString::Printf(TEXT("PrePivot=(X=%f,Y=%f,Z=%f)"), Random.FRandRange(-64.f, 64.f), Random.FRandRange(-64.f, 64.f), 0.f));
+	AddActorProperties(TEXT("StaticMeshActor"), Index);
+	AddLine(TEXT("   "), TEXT("End Object"));
+}
+
+void T3DCorpusGenerator::AddBrush(int32 Index)
+{
+	AddLine(TEXT("   "), FString::Printf(TEXT("Begin Object Class=Brush Name=Brush_%d Archetype=Brush'Engine.Default__Brush'"), Index));
+	AddLine(TEXT("      "), TEXT("Begin Object Class=BrushComponent Name=BrushComponent0 ObjectArchetype=BrushComponent'Engine.Default__Brush:BrushComponent0'"));
+	AddLine(TEXT("         "), FString::Printf(TEXT("Brush=Model'Model_%d'"), Index));
+	AddLine(TEXT("         "), TEXT("Name=\"BrushComponent0\""));
+	AddLine(TEXT("      "), TEXT("End Object"));
+	AddLine(TEXT("      "), Random.RandHelper(4) == 0 ? TEXT("CsgOper=CSG_Subtract") : TEXT("CsgOper=CSG_Add"));
+	AddLine(TEXT("      "), FString::Printf(TEXT("Begin Brush Name=Model_%d"), Index));
+	AddLine(TEXT("         "), TEXT("Begin PolyList"));
+
+	// Axis aligned squares are always valid polygons
+	for (int32 Polygon = 0; Polygon < Settings.PolygonsPerBrush; ++Polygon)
+	{
+		const FVector Origin(Random.FRandRange(-1024.f, 1024.f), Random.FRandRange(-1024.f, 1024.f), Random.FRandRange(-1024.f, 1024.f));
+		const float Size = Random.FRandRange(16.f, 512.f);
+
+		AddLine(TEXT("            "), FString::Printf(TEXT("Begin Polygon Texture=%s.Materials.Mat_%d Link=%d"), CorpusPackage, Random.RandHelper(FMath::Max(Settings.Materials, 1)), Polygon));
+		AddVector(TEXT("               "), TEXT("Origin"), Origin);
+		AddVector(TEXT("               "), TEXT("Normal"), FVector(0.f, 0.f, 1.f));
+		AddVector(TEXT("               "), TEXT("TextureU"), FVector(1.f, 0.f, 0.f));
+		AddVector(TEXT("               "), TEXT("TextureV"), FVector(0.f, 1.f, 0.f));
+		AddVector(TEXT("               "), TEXT("Vertex"), Origin);
+		AddVector(TEXT("               "), TEXT("Vertex"), Origin + FVector(0.f, Size, 0.f));
+		AddVector(TEXT("               "), TEXT("Vertex"), Origin + FVector(Size, Size, 0.f));
+		AddVector(TEXT("               "), TEXT("Vertex"), Origin + FVector(Size, 0.f, 0.f));
+		AddLine(TEXT("            "), TEXT("End Polygon"));
+	}
+
+	AddLine(TEXT("         "), TEXT("End PolyList"));
+	AddLine(TEXT("      "), TEXT("End Brush"));
+	AddNestedComponents(TEXT("      "));
+	AddLine(TEXT("      "), FString::Printf(TEXT("Brush=Model'Model_%d'"), Index));
+	AddLine(TEXT("      "), TEXT("BrushComponent=BrushComponent'BrushComponent0'"));
+	AddActorProperties(TEXT("Brush"), Index);
+	AddLine(TEXT("   "), TEXT("End Object"));
+}
+
+void T3DCorpusGenerator::AddLight(const TCHAR * Class, const TCHAR * ComponentClass, int32 Index)
+{
+	AddLine(TEXT("   "), FString::Printf(TEXT("Begin Object Class=%s Name=%s_%d Archetype=%s'Engine.Default__%s'"), Class, Class, Index, Class, Class));
+	AddLine(TEXT("      "), FString::Printf(TEXT("Begin Object Class=%s Name=LightComponent0 ObjectArchetype=%s'Engine.Default__%s:LightComponent0'"), ComponentClass, ComponentClass, Class));
+	AddLine(TEXT("         "), TEXT("Begin Object Class=DrawLightRadiusComponent Name=DrawLightRadius0"));
+	AddLine(TEXT("         "), TEXT("End Object"));
+	AddLine(TEXT("         "), FString::Printf(TEXT("Radius=%f"), Random.FRandRange(256.f, 4096.f)));
+	AddLine(TEXT("         "), FString::Printf(TEXT("Brightness=%f"), Random.FRandRange(0.1f, 4.f)));
+	AddLine(TEXT("         "), FString::Printf(TEXT("LightColor=(B=%d,G=%d,R=%d,A=0)"), Random.RandHelper(256), Random.RandHelper(256), Random.RandHelper(256)));
+	if (FCString::Strcmp(ComponentClass, TEXT("SpotLightComponent")) == 0)
+	{
+		AddLine(TEXT("         "), FString::Printf(TEXT("InnerConeAngle=%f"), Random.FRandRange(0.f, 22.f)));
+		AddLine(TEXT("         "), FString::Printf(TEXT("OuterConeAngle=%f"), Random.FRandRange(22.f, 44.f)));
+	}
+	AddLine(TEXT("         "), TEXT("Name=\"LightComponent0\""));
+	AddLine(TEXT("      "), TEXT("End Object"));
+	AddNestedComponents(TEXT("      "));
+	AddLine(TEXT("      "), TEXT("LightComponent=LightComponent0"));
+	AddLine(TEXT("      "), FString::Printf(TEXT("DrawScale3D=(X=%f,Y=1.000000,Z=1.000000)"), Random.FRandRange(0.5f, 2.0f)));
+	AddActorProperties(Class, Index);
+	AddLine(TEXT("   "), TEXT("End Object"));
+}
+
+void T3DCorpusGenerator::AddNestedComponents(const TCHAR * Indent)
+{
+	for (int32 Component = 0; Component < Settings.NestedComponents; ++Component)
+	{
+		AddLine(Indent, FString::Printf(TEXT("Begin Object Class=SpriteComponent Name=Sprite%d ObjectArchetype=SpriteComponent'Engine.Default__Actor:Sprite'"), Component));
+		AddLine(Indent, TEXT("   Sprite=Texture2D'EditorResources.S_Actor'"));
+		AddLine(Indent, TEXT("   HiddenGame=True"));
+		AddLine(Indent, FString::Printf(TEXT("   Name=\"Sprite%d\""), Component));
+		AddLine(Indent, TEXT("End Object"));
+	}
+}
+
+void T3DCorpusGenerator::AddActorProperties(const TCHAR * Class, int32 Index)
+{
+	AddLine(TEXT("      "), FString::Printf(TEXT("Location=(X=%f,Y=%f,Z=%f)"), Random.FRandRange(-32768.f, 32768.f), Random.FRandRange(-32768.f, 32768.f), Random.FRandRange(-4096.f, 4096.f)));
+	AddLine(TEXT("      "), FString::Printf(TEXT("Rotation=(Pitch=%d,Yaw=%d,Roll=%d)"), Random.RandRange(-32768, 32767), Random.RandRange(-32768, 32767), Random.RandRange(-32768, 32767)));
+	AddLine(TEXT("      "), FString::Printf(TEXT("Layer=\"Layer_%d\""), Random.RandHelper(8)));
+	AddLine(TEXT("      "), FString::Printf(TEXT("Tag=\"%s\""), Class));
+	AddLine(TEXT("      "), FString::Printf(TEXT("Name=\"%s_%d\""), Class, Index));
+	AddLine(TEXT("      "), FString::Printf(TEXT("ObjectArchetype=%s'Engine.Default__%s'"), Class, Class));
+}
+
+void T3DCorpusGenerator::AddLine(const TCHAR * Indent, const FString &Text)
+{
+	Buffer += Indent;
+	Buffer += Text;
+	Buffer += TEXT("\r\n");
+}
+
+void T3DCorpusGenerator::AddVector(const TCHAR * Indent, const TCHAR * Command, const FVector &Vector)
+{
+	AddLine(Indent, FString::Printf(TEXT("%-9s%+013.6f,%+013.6f,%+013.6f"), Command, Vector.X, Vector.Y, Vector.Z));
+}
+
+bool T3DCorpusGenerator::Flush(FArchive * Archive, bool bForce)
+{
+	if (Buffer.Len() < FlushSize && !bForce)
+		return true;
+
+	FTCHARToUTF8 Converter(*Buffer, Buffer.Len());
+	Archive->Serialize((void *)Converter.Get(), Converter.Length());
+	GeneratedBytes += Converter.Length();
+	Buffer.Reset();
+	return !Archive->IsError();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+
+class FArchive;
+
+/**
+* Writes synthetic UDK T3D exports, laid out like the importer's temporary directory.
+* Used to measure how the parsers scale with the size of the documents.
+*/
+class T3DCORPUS_API T3DCorpusGenerator
+{
+public:
+	struct FSettings
+	{
+		int32 StaticMeshActors = 10000;
+		int32 Brushes = 1000;
+		int32 PolygonsPerBrush = 6;
+		int32 PointLights = 500;
+		int32 SpotLights = 500;
+		int32 NestedComponents = 1; // Extra component blocks per actor, skipped by the importer
+		int32 Materials = 100;
+		int32 ExpressionsPerMaterial = 20;
+		int32 MaterialInstanceConstants = 100;
+		int32 Seed = 0;
+	};
+
+	explicit T3DCorpusGenerator(const FSettings &Settings);
+
+	/** Writes PersistentLevel.T3D, ExportedMaterials/ and ExportedMaterialInstances/ into Directory */
+	bool Generate(const FString &Directory);
+
+	/** Size in bytes of the files written by the last call to Generate */
+	int64 GetGeneratedBytes() const { return GeneratedBytes; }
+
+private:
+	bool WriteLevel(const FString &FileName);
+	bool WriteMaterial(const FString &FileName, int32 Index);
+	bool WriteMaterialInstanceConstant(const FString &FileName, int32 Index);
+
+	void AddStaticMeshActor(int32 Index);
+	void AddBrush(int32 Index);
+	void AddLight(const TCHAR * Class, const TCHAR * ComponentClass, int32 Index);
+	void AddNestedComponents(const TCHAR * Indent);
+	void AddActorProperties(const TCHAR * Class, int32 Index);
+
+	void AddLine(const TCHAR * Indent, const FString &Text);
+	void AddVector(const TCHAR * Indent, const TCHAR * Command, const FVector &Vector);
+	bool Flush(FArchive * Archive, bool bForce = false);
+
+	FSettings Settings;
+	FRandomStream Random;
+	FString Buffer;
+	int64 GeneratedBytes;
+};
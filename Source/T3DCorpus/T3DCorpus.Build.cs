@@ -0,0 +1,14 @@
+using UnrealBuildTool;
+
+public class T3DCorpus : ModuleRules
+{
+	public T3DCorpus(ReadOnlyTargetRules Target) : base(Target)
+	{
+		// Synthetic T3D documents for the benchmarks and tests, never shipped with the parser
+		PublicDependencyModuleNames.AddRange(
+			new string[] {
+				"Core"
+			}
+		);
+	}
+}
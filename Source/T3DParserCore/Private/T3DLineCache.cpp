@@ -0,0 +1,373 @@
+#include "T3DLineCache.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/Paths.h"
+#include "T3DReader.h"
+
+// Bump when the layout changes, caches of other versions are rebuilt
+static const uint32 CacheMagic = 0x43443354; // T3DC
+static const uint32 CacheVersion = 4;
+
+// Size of the mapped windows, same as T3DMappedLineReader
+static const int64 CacheWindowSize = 16 * 1024 * 1024;
+
+struct FCacheHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	int64 SourceSize;
+	int64 SourceTime; // Ticks of the modification date
+	int64 LinesEnd; // Offset of the block table
+	int64 NumBlocks;
+};
+
+/** Precedes the null-terminated UTF-8 bytes of each line, records are 8 bytes aligned. Tokens are offsets in the widened line */
+struct FCacheRecord
+{
+	int32 Len; // In bytes
+	int32 KeyLen;
+	int32 NameLen;
+	int32 ValueStart;
+	int32 ValueLen;
+	uint8 bNested;
+	uint8 bQuoted;
+	uint8 Padding[2];
+};
+
+/** Blocks are stored as they close, so the table is sorted by End. Blocks that are never closed are not stored */
+struct FCacheBlock
+{
+	int64 Begin; // Offset of the Begin record
+	int64 End; // Offset of the matching End record
+	int64 Lines; // Lines after Begin, End included
+};
+
+// Size of the chunks the block table is copied with
+static const int32 BlocksCopySize = 1024 * 1024;
+
+static inline int64 RecordSize(int32 Len)
+{
+	return Align(sizeof(FCacheRecord) + Len + 1, 8);
+}
+
+/** The cache is written under another name first, one that the *.??? scan of the export folders does not pick up */
+static inline FString PartialFileNameFor(const FString &CacheFileName)
+{
+	return CacheFileName + TEXT(".partial");
+}
+
+/** Blocks are spilled to their own file while the lines are written, then appended to the cache */
+static inline FString BlocksFileNameFor(const FString &CacheFileName)
+{
+	return CacheFileName + TEXT(".blocks.partial");
+}
+
+FString T3DLineCache::CacheFileNameFor(const FString &FileName)
+{
+	return FPaths::ChangeExtension(FileName, TEXT("t3dc"));
+}
+
+const uint8 * T3DCachedLineReader::FWindow::Map(IMappedFileHandle &Handle, int64 InOffset, int64 InSize, int64 End)
+{
+	if (InOffset < 0 || InSize < 0 || InOffset + InSize > End)
+		return NULL;
+
+	if (!Region.IsValid() || InOffset < Offset || InOffset + InSize > Offset + Size)
+	{
+		// Release the pages of the previous window first
+		Region.Reset();
+
+		Offset = InOffset;
+		Size = FMath::Min(FMath::Max(InSize, CacheWindowSize), End - InOffset);
+		Region.Reset(Handle.MapRegion(Offset, Size));
+		if (!Region.IsValid())
+			return NULL;
+	}
+
+	return Region->GetMappedPtr() + (InOffset - Offset);
+}
+
+T3DCachedLineReader::T3DCachedLineReader(IMappedFileHandle * Handle)
+	: Handle(Handle)
+{
+	FileSize = Handle->GetFileSize();
+	LinesEnd = 0;
+	Current = -1;
+	Next = sizeof(FCacheHeader);
+	NumBlocks = 0;
+	NextBlock = 0;
+}
+
+T3DCachedLineReader::~T3DCachedLineReader()
+{
+	// Regions must be released before their file handle
+	Lines.Region.Reset();
+	Blocks.Region.Reset();
+}
+
+TUniquePtr<T3DCachedLineReader> T3DCachedLineReader::Open(const FString &FileName, const FFileStatData &SourceStat)
+{
+	if (!SourceStat.bIsValid)
+		return nullptr;
+
+	IMappedFileHandle * Handle = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*T3DLineCache::CacheFileNameFor(FileName));
+	if (Handle == NULL)
+		return nullptr;
+
+	TUniquePtr<T3DCachedLineReader> Reader(new T3DCachedLineReader(Handle));
+	const FCacheHeader * Header = (const FCacheHeader *)Reader->Lines.Map(*Handle, 0, sizeof(FCacheHeader), Reader->FileSize);
+	if (Header == NULL
+		|| Header->Magic != CacheMagic
+		|| Header->Version != CacheVersion
+		|| Header->SourceSize != SourceStat.FileSize
+		|| Header->SourceTime != SourceStat.ModificationTime.GetTicks()
+		|| Header->LinesEnd < (int64)sizeof(FCacheHeader)
+		|| Header->NumBlocks < 0
+		|| Header->LinesEnd + Header->NumBlocks * (int64)sizeof(FCacheBlock) != Reader->FileSize)
+	{
+		return nullptr;
+	}
+
+	Reader->LinesEnd = Header->LinesEnd;
+	Reader->NumBlocks = Header->NumBlocks;
+	return Reader;
+}
+
+bool T3DCachedLineReader::ReadLineAt(int64 Offset, FStringView &OutLine)
+{
+	const FCacheRecord * Record = (const FCacheRecord *)Lines.Map(*Handle, Offset, sizeof(FCacheRecord), LinesEnd);
+	if (Record == NULL || Record->Len < 0)
+		return false;
+
+	// The window is moved if the line crosses it
+	const int64 Size = RecordSize(Record->Len);
+	Record = (const FCacheRecord *)Lines.Map(*Handle, Offset, Size, LinesEnd);
+	if (Record == NULL)
+		return false;
+
+	Tokens.KeyLen = Record->KeyLen;
+	Tokens.NameLen = Record->NameLen;
+	Tokens.ValueStart = Record->ValueStart;
+	Tokens.ValueLen = Record->ValueLen;
+	Tokens.bNested = Record->bNested != 0;
+	Tokens.bQuoted = Record->bQuoted != 0;
+	OutLine = WidenLine((const uint8 *)(Record + 1), 0, Record->Len, LineBuffer);
+
+	Current = Offset;
+	Next = Offset + Size;
+	return true;
+}
+
+bool T3DCachedLineReader::ReadLine(FStringView &OutLine)
+{
+	if (Next >= LinesEnd)
+		return false;
+
+	return ReadLineAt(Next, OutLine);
+}
+
+bool T3DCachedLineReader::GetLineTokens(FT3DLineTokens &OutTokens) const
+{
+	if (Current < 0)
+		return false;
+
+	OutTokens = Tokens;
+	return true;
+}
+
+bool T3DCachedLineReader::SkipBlock(FStringView &OutLine, int32 &SkippedLines)
+{
+	auto BlockAt = [this](int64 Index)
+	{
+		return (const FCacheBlock *)Blocks.Map(*Handle, LinesEnd + Index * sizeof(FCacheBlock), sizeof(FCacheBlock), FileSize);
+	};
+
+	// Blocks are sorted by End and lines are only read forward, blocks closed before the current line are passed once
+	while (NextBlock < NumBlocks)
+	{
+		const FCacheBlock * Block = BlockAt(NextBlock);
+		if (Block == NULL || Block->End >= Current)
+			break;
+
+		++NextBlock;
+	}
+
+	// The blocks held by the current one closed before it, the blocks holding it close after it
+	for (int64 Index = NextBlock; Index < NumBlocks; ++Index)
+	{
+		const FCacheBlock * Block = BlockAt(Index);
+		if (Block == NULL || Block->Begin < Current)
+			return false;
+
+		if (Block->Begin == Current)
+		{
+			const int64 End = Block->End;
+			const int32 BlockLines = (int32)Block->Lines;
+			if (!ReadLineAt(End, OutLine))
+				return false;
+
+			NextBlock = Index + 1;
+			SkippedLines = BlockLines;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+T3DCacheWriterLineReader::T3DCacheWriterLineReader(TUniquePtr<T3DLineReader> &&Source, FArchive * Archive, FArchive * BlocksArchive, const FString &FileName, const FFileStatData &SourceStat)
+	: Source(MoveTemp(Source)), Archive(Archive), BlocksArchive(BlocksArchive), SourceStat(SourceStat)
+{
+	CacheFileName = T3DLineCache::CacheFileNameFor(FileName);
+	TempFileName = PartialFileNameFor(CacheFileName);
+	BlocksFileName = BlocksFileNameFor(CacheFileName);
+	bFinished = false;
+	LineCount = 0;
+	NumBlocks = 0;
+}
+
+T3DCacheWriterLineReader::~T3DCacheWriterLineReader()
+{
+	// The parser stopped before the end of the document, the rest of it is not read just for the cache
+	if (!bFinished)
+		Discard();
+}
+
+TUniquePtr<T3DCacheWriterLineReader> T3DCacheWriterLineReader::Open(TUniquePtr<T3DLineReader> &Source, const FString &FileName, const FFileStatData &SourceStat)
+{
+	if (!SourceStat.bIsValid)
+		return nullptr;
+
+	const FString CacheFileName = T3DLineCache::CacheFileNameFor(FileName);
+	TUniquePtr<FArchive> Archive(IFileManager::Get().CreateFileWriter(*PartialFileNameFor(CacheFileName)));
+	TUniquePtr<FArchive> BlocksArchive(IFileManager::Get().CreateFileWriter(*BlocksFileNameFor(CacheFileName)));
+	if (!Archive.IsValid() || !BlocksArchive.IsValid())
+	{
+		Archive.Reset();
+		BlocksArchive.Reset();
+		IFileManager::Get().Delete(*PartialFileNameFor(CacheFileName));
+		IFileManager::Get().Delete(*BlocksFileNameFor(CacheFileName));
+		return nullptr;
+	}
+
+	TUniquePtr<T3DCacheWriterLineReader> Writer(new T3DCacheWriterLineReader(MoveTemp(Source), Archive.Release(), BlocksArchive.Release(), FileName, SourceStat));
+	Writer->WriteHeader(0);
+	return Writer;
+}
+
+void T3DCacheWriterLineReader::WriteHeader(int64 LinesEnd)
+{
+	FCacheHeader Header;
+	FMemory::Memzero(Header);
+	Header.Magic = CacheMagic;
+	Header.Version = CacheVersion;
+	Header.SourceSize = SourceStat.FileSize;
+	Header.SourceTime = SourceStat.ModificationTime.GetTicks();
+	Header.LinesEnd = LinesEnd;
+	Header.NumBlocks = NumBlocks;
+	Archive->Serialize(&Header, sizeof(Header));
+}
+
+bool T3DCacheWriterLineReader::ReadLine(FStringView &OutLine)
+{
+	if (bFinished)
+		return false;
+
+	if (!Source->ReadLine(OutLine))
+	{
+		Finish();
+		return false;
+	}
+
+	T3DReader::TokenizeLine(OutLine, Tokens);
+
+	// Blocks are matched like T3DReader::JumpToEnd does
+	const int64 Offset = Archive->Tell();
+	if (OutLine.StartsWith(TEXT("Begin "), ESearchCase::CaseSensitive))
+	{
+		OpenBlocks.Push({ Offset, LineCount });
+	}
+	else if (OutLine.StartsWith(TEXT("End "), ESearchCase::CaseSensitive) && OpenBlocks.Num() > 0)
+	{
+		const FOpenBlock Block = OpenBlocks.Pop(false);
+		FCacheBlock CacheBlock = { Block.Begin, Offset, LineCount - Block.Lines };
+		BlocksArchive->Serialize(&CacheBlock, sizeof(CacheBlock));
+		++NumBlocks;
+	}
+	++LineCount;
+
+	const FTCHARToUTF8 Converter(OutLine.GetData(), OutLine.Len());
+	FCacheRecord Record;
+	FMemory::Memzero(Record);
+	Record.Len = Converter.Length();
+	Record.KeyLen = Tokens.KeyLen;
+	Record.NameLen = Tokens.NameLen;
+	Record.ValueStart = Tokens.ValueStart;
+	Record.ValueLen = Tokens.ValueLen;
+	Record.bNested = Tokens.bNested ? 1 : 0;
+	Record.bQuoted = Tokens.bQuoted ? 1 : 0;
+	Archive->Serialize(&Record, sizeof(Record));
+	Archive->Serialize((void *)Converter.Get(), Record.Len);
+
+	// Null terminator and alignment
+	uint8 Padding[8] = { 0 };
+	Archive->Serialize(Padding, RecordSize(Record.Len) - sizeof(Record) - Record.Len);
+	return true;
+}
+
+bool T3DCacheWriterLineReader::GetLineTokens(FT3DLineTokens &OutTokens) const
+{
+	OutTokens = Tokens;
+	return true;
+}
+
+void T3DCacheWriterLineReader::Finish()
+{
+	bFinished = true;
+
+	// The block table follows the lines
+	const int64 LinesEnd = Archive->Tell();
+	bool bSuccess = !BlocksArchive->IsError() && BlocksArchive->Close();
+	BlocksArchive.Reset();
+
+	TUniquePtr<FArchive> BlocksReader(bSuccess ? IFileManager::Get().CreateFileReader(*BlocksFileName) : NULL);
+	bSuccess = BlocksReader.IsValid();
+	if (bSuccess)
+	{
+		TArray<uint8> Chunk;
+		for (int64 Remaining = BlocksReader->TotalSize(); Remaining > 0 && !BlocksReader->IsError(); )
+		{
+			const int32 Size = (int32)FMath::Min<int64>(Remaining, BlocksCopySize);
+			Chunk.SetNumUninitialized(Size, false);
+			BlocksReader->Serialize(Chunk.GetData(), Size);
+			Archive->Serialize(Chunk.GetData(), Size);
+			Remaining -= Size;
+		}
+		bSuccess = !BlocksReader->IsError();
+		BlocksReader.Reset();
+	}
+	IFileManager::Get().Delete(*BlocksFileName);
+
+	// The block table is only known once every line was written
+	Archive->Seek(0);
+	WriteHeader(LinesEnd);
+
+	bSuccess = bSuccess && !Archive->IsError() && Archive->Close();
+	Archive.Reset();
+
+	if (bSuccess)
+		IFileManager::Get().Move(*CacheFileName, *TempFileName, true);
+	else
+		IFileManager::Get().Delete(*TempFileName);
+}
+
+void T3DCacheWriterLineReader::Discard()
+{
+	bFinished = true;
+	Archive.Reset();
+	BlocksArchive.Reset();
+	IFileManager::Get().Delete(*TempFileName);
+	IFileManager::Get().Delete(*BlocksFileName);
+}
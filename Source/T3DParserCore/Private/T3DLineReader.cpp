@@ -0,0 +1,292 @@
+#include "T3DLineReader.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+
+// Size of the mapped window, lines longer than this grow the window
+static const int64 MappedWindowSize = 16 * 1024 * 1024;
+
+// Size of the chunks read by the stream reader
+static const int32 StreamChunkSize = 1024 * 1024;
+
+static inline bool IsWhitespace(TCHAR c)
+{
+	return c == LITERAL(TCHAR, ' ') || c == LITERAL(TCHAR, '\t') || c == LITERAL(TCHAR, '\r');
+}
+
+FStringView T3DLineReader::WidenLine(const uint8 * Data, int64 Start, int64 Stop, TArray<TCHAR> &LineBuffer)
+{
+	// Trimming
+	while (Start < Stop && IsWhitespace(Data[Start]))
+	{
+		++Start;
+	}
+
+	while (Stop > Start && IsWhitespace(Data[Stop - 1]))
+	{
+		--Stop;
+	}
+
+	// Widening, ASCII lines are copied directly
+	const ANSICHAR * Bytes = (const ANSICHAR *)(Data + Start);
+	const int32 Len = (int32)(Stop - Start);
+	int32 Index = 0;
+	LineBuffer.SetNumUninitialized(Len + 1, false);
+	while (Index < Len && (uint8)Bytes[Index] < 0x80)
+	{
+		LineBuffer[Index] = (TCHAR)Bytes[Index];
+		++Index;
+	}
+
+	if (Index < Len)
+	{
+		FUTF8ToTCHAR Converter(Bytes, Len);
+		LineBuffer.SetNumUninitialized(Converter.Length() + 1, false);
+		FMemory::Memcpy(LineBuffer.GetData(), Converter.Get(), Converter.Length() * sizeof(TCHAR));
+	}
+
+	const int32 LineLen = LineBuffer.Num() - 1;
+	LineBuffer[LineLen] = LITERAL(TCHAR, '\0');
+	return FStringView(LineBuffer.GetData(), LineLen);
+}
+
+/** Tells if a document starting with these bytes is UTF-16 encoded */
+static bool IsUTF16(const uint8 * Bytes, int64 Size)
+{
+	return Size >= 2 && ((Bytes[0] == 0xFF && Bytes[1] == 0xFE) || (Bytes[0] == 0xFE && Bytes[1] == 0xFF));
+}
+
+/** Tells if a document starts with an UTF-8 byte order mark */
+static bool HasUTF8BOM(const uint8 * Bytes, int64 Size)
+{
+	return Size >= 3 && Bytes[0] == 0xEF && Bytes[1] == 0xBB && Bytes[2] == 0xBF;
+}
+
+T3DStringLineReader::T3DStringLineReader(FString &&Content)
+{
+	Buffer = MoveTemp(Content.GetCharArray());
+	Position = 0;
+}
+
+bool T3DStringLineReader::ReadLine(FStringView &OutLine)
+{
+	// Last character of the buffer is the string terminator
+	const int32 End = Buffer.Num() > 0 ? Buffer.Num() - 1 : 0;
+	TCHAR * Data = Buffer.GetData();
+
+	while (Position < End)
+	{
+		int32 Start = Position;
+		int32 Stop = Position;
+		while (Stop < End && Data[Stop] != LITERAL(TCHAR, '\n'))
+		{
+			++Stop;
+		}
+		Position = Stop + 1;
+
+		// Empty lines are culled
+		if (Stop == Start)
+			continue;
+
+		// Trimming
+		while (Start < Stop && IsWhitespace(Data[Start]))
+		{
+			++Start;
+		}
+
+		while (Stop > Start && IsWhitespace(Data[Stop - 1]))
+		{
+			--Stop;
+		}
+
+		Data[Stop] = LITERAL(TCHAR, '\0');
+		OutLine = FStringView(Data + Start, Stop - Start);
+		return true;
+	}
+
+	return false;
+}
+
+T3DMappedLineReader::T3DMappedLineReader(IMappedFileHandle * Handle)
+	: Handle(Handle)
+{
+	FileSize = Handle->GetFileSize();
+	RegionOffset = 0;
+	RegionSize = 0;
+	Position = 0;
+}
+
+T3DMappedLineReader::~T3DMappedLineReader()
+{
+	// Regions must be released before their file handle
+	Region.Reset();
+}
+
+TUniquePtr<T3DMappedLineReader> T3DMappedLineReader::Open(const FString &FileName)
+{
+	IMappedFileHandle * Handle = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FileName);
+	if (Handle == NULL)
+		return nullptr;
+
+	TUniquePtr<T3DMappedLineReader> Reader(new T3DMappedLineReader(Handle));
+	if (Reader->FileSize > 0)
+	{
+		if (!Reader->MapWindow(0, MappedWindowSize))
+			return nullptr;
+
+		const uint8 * Bytes = Reader->Region->GetMappedPtr();
+		if (IsUTF16(Bytes, Reader->RegionSize))
+		{
+			// UTF-16 documents are left to FFileHelper
+			return nullptr;
+		}
+
+		if (HasUTF8BOM(Bytes, Reader->RegionSize))
+		{
+			Reader->Position = 3;
+		}
+	}
+
+	return Reader;
+}
+
+bool T3DMappedLineReader::MapWindow(int64 Offset, int64 Size)
+{
+	// Release the pages of the previous window first
+	Region.Reset();
+
+	RegionOffset = Offset;
+	RegionSize = FMath::Min(Size, FileSize - Offset);
+	Region.Reset(Handle->MapRegion(RegionOffset, RegionSize));
+	return Region.IsValid();
+}
+
+bool T3DMappedLineReader::ReadLine(FStringView &OutLine)
+{
+	while (Position < FileSize)
+	{
+		if (Position < RegionOffset || Position >= RegionOffset + RegionSize)
+		{
+			if (!MapWindow(Position, MappedWindowSize))
+				return false;
+		}
+
+		// Find the end of the line, mapping the window again if the line crosses it
+		const uint8 * Data = Region->GetMappedPtr();
+		int64 Start = Position - RegionOffset;
+		int64 Stop = Start;
+		while (Stop < RegionSize && Data[Stop] != '\n')
+		{
+			++Stop;
+		}
+
+		if (Stop == RegionSize && RegionOffset + RegionSize < FileSize)
+		{
+			if (!MapWindow(Position, (RegionSize - Start) * 2 + MappedWindowSize))
+				return false;
+			continue;
+		}
+		Position = RegionOffset + Stop + 1;
+
+		// Empty lines are culled
+		if (Stop == Start)
+			continue;
+
+		OutLine = WidenLine(Data, Start, Stop, LineBuffer);
+		return true;
+	}
+
+	return false;
+}
+
+T3DStreamLineReader::T3DStreamLineReader(FArchive * Archive)
+	: Archive(Archive)
+{
+	Position = 0;
+}
+
+T3DStreamLineReader::~T3DStreamLineReader()
+{
+}
+
+TUniquePtr<T3DStreamLineReader> T3DStreamLineReader::Open(const FString &FileName)
+{
+	FArchive * Archive = IFileManager::Get().CreateFileReader(*FileName);
+	if (Archive == NULL)
+		return nullptr;
+
+	TUniquePtr<T3DStreamLineReader> Reader(new T3DStreamLineReader(Archive));
+	if (!Reader->ReadChunk())
+		return Reader;
+
+	const uint8 * Bytes = Reader->Chunk.GetData();
+	if (IsUTF16(Bytes, Reader->Chunk.Num()))
+	{
+		// UTF-16 documents are left to FFileHelper
+		return nullptr;
+	}
+
+	if (HasUTF8BOM(Bytes, Reader->Chunk.Num()))
+	{
+		Reader->Position = 3;
+	}
+
+	return Reader;
+}
+
+bool T3DStreamLineReader::ReadChunk()
+{
+	const int64 Remaining = Archive->TotalSize() - Archive->Tell();
+	if (Remaining <= 0)
+		return false;
+
+	// Drop the consumed bytes, only the current partial line is kept
+	Chunk.RemoveAt(0, Position, false);
+	Position = 0;
+
+	const int32 Offset = Chunk.Num();
+	const int32 Size = (int32)FMath::Min<int64>(Remaining, StreamChunkSize);
+	Chunk.SetNumUninitialized(Offset + Size, false);
+	Archive->Serialize(Chunk.GetData() + Offset, Size);
+	return !Archive->IsError();
+}
+
+bool T3DStreamLineReader::ReadLine(FStringView &OutLine)
+{
+	int32 Stop = Position;
+	for (;;)
+	{
+		// Find the end of the line, reading another chunk if it is not complete
+		while (Stop < Chunk.Num() && Chunk[Stop] != '\n')
+		{
+			++Stop;
+		}
+
+		if (Stop == Chunk.Num())
+		{
+			const int32 Consumed = Position;
+			if (ReadChunk())
+			{
+				Stop -= Consumed;
+				continue;
+			}
+
+			if (Position == Chunk.Num())
+				return false;
+		}
+
+		const int32 Start = Position;
+		Position = FMath::Min(Stop + 1, Chunk.Num());
+
+		// Empty lines are culled, the next line is searched from its own start
+		if (Stop == Start)
+		{
+			Stop = Position;
+			continue;
+		}
+
+		OutLine = WidenLine(Chunk.GetData(), Start, Stop, LineBuffer);
+		return true;
+	}
+}
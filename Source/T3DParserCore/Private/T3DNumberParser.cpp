@@ -0,0 +1,242 @@
+#include "T3DNumberParser.h"
+
+// Powers of ten that are exactly representable as doubles
+static const double ExactPowersOf10[] =
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+	1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Mantissas up to 15 digits are exactly representable as doubles
+static const int32 MaxExactDigits = 15;
+
+// Digits kept in the 64 bits mantissa
+static const int32 MaxMantissaDigits = 19;
+
+static inline bool IsDigit(TCHAR c)
+{
+	return c >= LITERAL(TCHAR, '0') && c <= LITERAL(TCHAR, '9');
+}
+
+static inline bool IsSpace(TCHAR c)
+{
+	return c == LITERAL(TCHAR, ' ') || c == LITERAL(TCHAR, '\t');
+}
+
+bool T3DNumberParser::ParseNumber(const TCHAR * &Stream, double &Value)
+{
+	const TCHAR * Cursor = Stream;
+	while (IsSpace(*Cursor))
+	{
+		++Cursor;
+	}
+
+	const TCHAR * Start = Cursor;
+	const bool bNegative = *Cursor == LITERAL(TCHAR, '-');
+	if (*Cursor == LITERAL(TCHAR, '-') || *Cursor == LITERAL(TCHAR, '+'))
+	{
+		++Cursor;
+	}
+
+	// Mantissa, leading zeros are not significant
+	uint64 Mantissa = 0;
+	int32 Digits = 0, Exponent = 0;
+	bool bHasDigits = false, bTruncated = false;
+	for (; IsDigit(*Cursor); ++Cursor)
+	{
+		bHasDigits = true;
+		if (Mantissa == 0 && *Cursor == LITERAL(TCHAR, '0'))
+			continue;
+
+		if (Digits < MaxMantissaDigits)
+		{
+			Mantissa = Mantissa * 10 + (*Cursor - LITERAL(TCHAR, '0'));
+			++Digits;
+		}
+		else
+		{
+			bTruncated = true;
+			++Exponent;
+		}
+	}
+
+	if (*Cursor == LITERAL(TCHAR, '.'))
+	{
+		for (++Cursor; IsDigit(*Cursor); ++Cursor)
+		{
+			bHasDigits = true;
+			if (Mantissa == 0 && *Cursor == LITERAL(TCHAR, '0'))
+			{
+				--Exponent;
+			}
+			else if (Digits < MaxMantissaDigits)
+			{
+				Mantissa = Mantissa * 10 + (*Cursor - LITERAL(TCHAR, '0'));
+				++Digits;
+				--Exponent;
+			}
+			else
+			{
+				bTruncated = true;
+			}
+		}
+	}
+
+	if (!bHasDigits)
+		return false;
+
+	// Exponent, only consumed if it has digits
+	if (*Cursor == LITERAL(TCHAR, 'e') || *Cursor == LITERAL(TCHAR, 'E'))
+	{
+		const TCHAR * ExponentCursor = Cursor + 1;
+		const bool bNegativeExponent = *ExponentCursor == LITERAL(TCHAR, '-');
+		if (*ExponentCursor == LITERAL(TCHAR, '-') || *ExponentCursor == LITERAL(TCHAR, '+'))
+		{
+			++ExponentCursor;
+		}
+
+		if (IsDigit(*ExponentCursor))
+		{
+			int32 ExplicitExponent = 0;
+			for (; IsDigit(*ExponentCursor); ++ExponentCursor)
+			{
+				if (ExplicitExponent < 100000)
+					ExplicitExponent = ExplicitExponent * 10 + (*ExponentCursor - LITERAL(TCHAR, '0'));
+			}
+			Exponent += bNegativeExponent ? -ExplicitExponent : ExplicitExponent;
+			Cursor = ExponentCursor;
+		}
+	}
+
+	if (Mantissa == 0)
+	{
+		Value = bNegative ? -0.0 : 0.0;
+	}
+	else if (!bTruncated && Digits <= MaxExactDigits && Exponent >= -22 && Exponent <= 22)
+	{
+		// Both operands are exact, so the single rounding of the operation gives the correctly rounded result
+		Value = (double)Mantissa;
+		Value = Exponent < 0 ? Value / ExactPowersOf10[-Exponent] : Value * ExactPowersOf10[Exponent];
+		if (bNegative)
+			Value = -Value;
+	}
+	else
+	{
+		// Rare long or huge numbers are left to the CRT
+		Value = FCString::Atod(Start);
+	}
+
+	Stream = Cursor;
+	return true;
+}
+
+uint32 T3DNumberParser::ParseFields(const TCHAR * Stream, const TCHAR * const * Keys, int32 NumKeys, double * Values)
+{
+	uint32 Found = 0;
+	const TCHAR * Cursor = Stream;
+	if (*Cursor == LITERAL(TCHAR, '('))
+	{
+		++Cursor;
+	}
+
+	while (*Cursor && *Cursor != LITERAL(TCHAR, ')'))
+	{
+		while (IsSpace(*Cursor))
+		{
+			++Cursor;
+		}
+
+		// Key
+		const TCHAR * Key = Cursor;
+		while (FChar::IsAlnum(*Cursor) || *Cursor == LITERAL(TCHAR, '_'))
+		{
+			++Cursor;
+		}
+
+		const int32 KeyLen = (int32)(Cursor - Key);
+		if (KeyLen > 0 && *Cursor == LITERAL(TCHAR, '='))
+		{
+			++Cursor;
+			for (int32 Index = 0; Index < NumKeys; ++Index)
+			{
+				if (FCString::Strnicmp(Key, Keys[Index], KeyLen) == 0 && Keys[Index][KeyLen] == 0)
+				{
+					if (ParseNumber(Cursor, Values[Index]))
+						Found |= 1u << Index;
+					break;
+				}
+			}
+		}
+
+		// Skip what is left of the field, nested values included
+		int32 Level = 0;
+		while (*Cursor && (Level > 0 || (*Cursor != LITERAL(TCHAR, ',') && *Cursor != LITERAL(TCHAR, ')'))))
+		{
+			if (*Cursor == LITERAL(TCHAR, '('))
+				++Level;
+			else if (*Cursor == LITERAL(TCHAR, ')'))
+				--Level;
+			++Cursor;
+		}
+
+		if (*Cursor == LITERAL(TCHAR, ','))
+		{
+			++Cursor;
+		}
+	}
+
+	return Found;
+}
+
+bool T3DNumberParser::ParseTriple(const TCHAR * Stream, FVector &Value)
+{
+	double Components[3] = { 0.0, 0.0, 0.0 };
+	for (int32 Index = 0; Index < 3; ++Index)
+	{
+		if (Index > 0)
+		{
+			Stream = FCString::Strchr(Stream, LITERAL(TCHAR, ','));
+			if (!Stream)
+			{
+				Value = FVector((float)Components[0], (float)Components[1], (float)Components[2]);
+				return false;
+			}
+			++Stream;
+		}
+
+		ParseNumber(Stream, Components[Index]);
+	}
+
+	Value = FVector((float)Components[0], (float)Components[1], (float)Components[2]);
+	return true;
+}
+
+bool T3DNumberParser::ParseVector(const TCHAR * Stream, FVector &Value)
+{
+	static const TCHAR * const Keys[] = { TEXT("X"), TEXT("Y"), TEXT("Z") };
+	double Components[3] = { 0.0, 0.0, 0.0 };
+
+	const uint32 Found = ParseFields(Stream, Keys, 3, Components);
+	Value = FVector((float)Components[0], (float)Components[1], (float)Components[2]);
+	return Found == 0x7;
+}
+
+bool T3DNumberParser::ParseColor(const TCHAR * Stream, FColor &Value)
+{
+	static const TCHAR * const Keys[] = { TEXT("R"), TEXT("G"), TEXT("B"), TEXT("A") };
+	double Components[4] = { 0.0, 0.0, 0.0, 255.0 };
+
+	const uint32 Found = ParseFields(Stream, Keys, 4, Components);
+	Value = FColor((uint8)(int32)Components[0], (uint8)(int32)Components[1], (uint8)(int32)Components[2], (uint8)(int32)Components[3]);
+	return (Found & 0x7) == 0x7;
+}
+
+bool T3DNumberParser::ParseLinearColor(const TCHAR * Stream, FLinearColor &Value)
+{
+	static const TCHAR * const Keys[] = { TEXT("R"), TEXT("G"), TEXT("B"), TEXT("A") };
+	double Components[4] = { 0.0, 0.0, 0.0, 1.0 };
+
+	const uint32 Found = ParseFields(Stream, Keys, 4, Components);
+	Value = FLinearColor((float)Components[0], (float)Components[1], (float)Components[2], (float)Components[3]);
+	return (Found & 0x7) == 0x7;
+}
@@ -0,0 +1,427 @@
+#include "T3DReader.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "T3DLineCache.h"
+#include "T3DNumberParser.h"
+
+float T3DReader::UnrRotToDeg = 0.00549316540360483;
+
+T3DReader::T3DReader()
+{
+	this->LineIndex = 0;
+	this->ParserLevel = 0;
+	this->Line = FStringView(TEXT(""));
+	this->bUseCache = true;
+}
+
+void T3DReader::ResetParser(FString &&Content)
+{
+	LineIndex = 0;
+	ParserLevel = 0;
+	Line = FStringView(TEXT(""));
+	LineProperty = FLineProperty();
+	Reader = MakeUnique<T3DStringLineReader>(MoveTemp(Content));
+}
+
+bool T3DReader::ResetParserFromFile(const FString &FileName, bool bStreamed)
+{
+	LineIndex = 0;
+	ParserLevel = 0;
+	Line = FStringView(TEXT(""));
+	LineProperty = FLineProperty();
+
+	// Lines already tokenized by a previous run are read from the cache
+	const FFileStatData SourceStat = bUseCache ? IFileManager::Get().GetStatData(*FileName) : FFileStatData();
+	Reader = T3DCachedLineReader::Open(FileName, SourceStat);
+	if (Reader.IsValid())
+		return true;
+
+	// Parse the file in place when it can be streamed or mapped
+	if (bStreamed)
+		Reader = T3DStreamLineReader::Open(FileName);
+	else
+		Reader = T3DMappedLineReader::Open(FileName);
+
+	if (!Reader.IsValid())
+	{
+		FString Content;
+		if (!FFileHelper::LoadFileToString(Content, *FileName))
+			return false;
+
+		Reader = MakeUnique<T3DStringLineReader>(MoveTemp(Content));
+	}
+
+	// The cache is written while the file is parsed
+	if (TUniquePtr<T3DCacheWriterLineReader> CacheWriter = T3DCacheWriterLineReader::Open(Reader, FileName, SourceStat))
+		Reader = MoveTemp(CacheWriter);
+
+	return true;
+}
+
+bool T3DReader::NextLine()
+{
+	if (Reader.IsValid() && Reader->ReadLine(Line))
+	{
+		++LineIndex;
+		TokenizeLine();
+		return true;
+	}
+	return false;
+}
+
+void T3DReader::FinishDocument()
+{
+	// Once the document is parsed, the lines left are read so a cache being written is kept
+	while (Reader.IsValid() && Reader->ReadLine(Line))
+	{
+		++LineIndex;
+	}
+
+	Line = FStringView(TEXT(""));
+	LineProperty = FLineProperty();
+}
+
+/// Scans the value starting at Start, returns its end. Start is moved past the opening quote of quoted values.
+static const TCHAR * ScanValue(const TCHAR * &Start, bool &bNested, bool &bQuoted)
+{
+	const TCHAR * Buffer = Start;
+	bNested = false;
+	bQuoted = false;
+	if (*Buffer == TCHAR('"'))
+	{
+		bQuoted = true;
+		++Start;
+		++Buffer;
+		bool Escaping = false;
+		while (*Buffer && (*Buffer != TCHAR('"') || Escaping))
+		{
+			if (Escaping)
+				Escaping = false;
+			else if (*Buffer == TCHAR('\\'))
+				Escaping = true;
+			++Buffer;
+		}
+	}
+	else if(*Buffer == TCHAR('('))
+	{
+		bNested = true;
+		++Buffer;
+		int Level = 1;
+		while (*Buffer && Level != 0)
+		{
+			if (*Buffer == TCHAR('('))
+				++Level;
+			else if (*Buffer == TCHAR(')'))
+				--Level;
+			++Buffer;
+		}
+	}
+	else
+	{
+		while (*Buffer && *Buffer != TCHAR(' ') && *Buffer != TCHAR(',') && *Buffer != TCHAR(')'))
+		{
+			++Buffer;
+		}
+	}
+	return Buffer;
+}
+
+void T3DReader::TokenizeLine(FStringView Line, FT3DLineTokens &Tokens)
+{
+	Tokens = FT3DLineTokens();
+
+	// Key, everything before the first '=' as IsProperty always took it
+	const TCHAR * Data = Line.GetData();
+	const TCHAR * End = Data + Line.Len();
+	const TCHAR * Cursor = Data;
+	while (Cursor < End && *Cursor != TCHAR('='))
+	{
+		++Cursor;
+	}
+
+	if (Cursor == Data || Cursor == End)
+		return;
+
+	// Name(Index) keys are array parameters, their name stops before the index
+	const TCHAR * NameEnd = Cursor;
+	if (Cursor[-1] == TCHAR(')'))
+	{
+		const TCHAR * Index = Cursor - 1;
+		while (Index > Data && FChar::IsAlnum(Index[-1]))
+		{
+			--Index;
+		}
+		if (Index - 1 > Data && Index[-1] == TCHAR('('))
+		{
+			NameEnd = Index - 1;
+		}
+	}
+
+	const TCHAR * ValueStart = Cursor + 1;
+	const TCHAR * ValueEnd = ScanValue(ValueStart, Tokens.bNested, Tokens.bQuoted);
+
+	Tokens.KeyLen = (int32)(Cursor - Data);
+	Tokens.NameLen = (int32)(NameEnd - Data);
+	Tokens.ValueStart = (int32)(ValueStart - Data);
+	Tokens.ValueLen = (int32)(ValueEnd - ValueStart);
+}
+
+void T3DReader::TokenizeLine()
+{
+	// Cached documents already know the tokens of their lines
+	FT3DLineTokens Tokens;
+	if (!Reader->GetLineTokens(Tokens))
+		TokenizeLine(Line, Tokens);
+
+	const TCHAR * Data = Line.GetData();
+	LineProperty = FLineProperty();
+	if (Tokens.KeyLen > 0)
+	{
+		LineProperty.Key = FStringView(Data, Tokens.KeyLen);
+		LineProperty.Name = FStringView(Data, Tokens.NameLen);
+		LineProperty.Value = FStringView(Data + Tokens.ValueStart, Tokens.ValueLen);
+		LineProperty.bNested = Tokens.bNested;
+		LineProperty.bQuoted = Tokens.bQuoted;
+	}
+}
+
+bool T3DReader::IgnoreSubObjects()
+{
+	while (Line.StartsWith(TEXT("Begin Object "), ESearchCase::CaseSensitive))
+	{
+		JumpToEnd();
+		if (!NextLine())
+			return false;
+	}
+
+	return true;
+}
+
+bool T3DReader::IgnoreSubs()
+{
+	while (Line.StartsWith(TEXT("Begin "), ESearchCase::CaseSensitive))
+	{
+		JumpToEnd();
+		if (!NextLine())
+			return false;
+	}
+
+	return true;
+}
+
+void T3DReader::JumpToEnd()
+{
+	int32 SkippedLines;
+	if (Reader.IsValid() && Reader->SkipBlock(Line, SkippedLines))
+	{
+		LineIndex += SkippedLines;
+		TokenizeLine();
+		return;
+	}
+
+	int32 Level = 1;
+	while (NextLine())
+	{
+		if (Line.StartsWith(TEXT("Begin "), ESearchCase::CaseSensitive))
+		{
+			++Level;
+		}
+		else if (Line.StartsWith(TEXT("End "), ESearchCase::CaseSensitive))
+		{
+			--Level;
+			if (Level == 0)
+				break;
+		}
+	}
+}
+
+void T3DReader::ReadBlock(FString &Block)
+{
+	Block.Reset();
+	Block.AppendChars(Line.GetData(), Line.Len());
+
+	int32 Level = 1;
+	while (NextLine())
+	{
+		Block.AppendChar(TCHAR('\n'));
+		Block.AppendChars(Line.GetData(), Line.Len());
+
+		if (Line.StartsWith(TEXT("Begin "), ESearchCase::CaseSensitive))
+		{
+			++Level;
+		}
+		else if (Line.StartsWith(TEXT("End "), ESearchCase::CaseSensitive))
+		{
+			--Level;
+			if (Level == 0)
+				break;
+		}
+	}
+}
+
+bool T3DReader::IsBeginObject(FString &Class)
+{
+	if (Line.StartsWith(TEXT("Begin Object "), ESearchCase::CaseSensitive))
+	{
+		GetOneValueAfter(TEXT(" Class="), Class);
+		return true;
+	}
+	return false;
+}
+
+bool T3DReader::IsEndObject()
+{
+	return Line.Equals(TEXT("End Object"));
+}
+
+bool T3DReader::GetOneValueAfter(const TCHAR * Key, FString &Value, int32 maxindex)
+{
+	// Line is null-terminated in place by the reader
+	const TCHAR * Found = FCString::Strstr(Line.GetData(), Key);
+	if (Found != NULL && Found - Line.GetData() <= maxindex)
+	{
+		const TCHAR * Start = Found + FCString::Strlen(Key);
+		bool bNested, bQuoted;
+		const TCHAR * Buffer = ScanValue(Start, bNested, bQuoted);
+		Value = FString((int32)(Buffer - Start), Start);
+
+		return true;
+	}
+	return false;
+}
+
+bool T3DReader::GetProperty(const TCHAR * Key, float &Value)
+{
+	if (IsPropertyKey(Key))
+	{
+		const TCHAR * Stream = LineProperty.Value.GetData();
+		double Number = 0.0;
+		T3DNumberParser::ParseNumber(Stream, Number);
+		Value = (float)Number;
+		return true;
+	}
+	return false;
+}
+
+bool T3DReader::GetProperty(const TCHAR * Key, FVector &Value)
+{
+	if (IsPropertyKey(Key))
+	{
+		ensure(T3DNumberParser::ParseVector(LineProperty.Value.GetData(), Value));
+		return true;
+	}
+	return false;
+}
+
+bool T3DReader::GetProperty(const TCHAR * Key, FRotator &Value)
+{
+	if (IsPropertyKey(Key))
+	{
+		ensure(ParseUDKRotation(LineProperty.Value.GetData(), Value));
+		return true;
+	}
+	return false;
+}
+
+bool T3DReader::GetProperty(const TCHAR * Key, FColor &Value)
+{
+	if (IsPropertyKey(Key))
+	{
+		T3DNumberParser::ParseColor(LineProperty.Value.GetData(), Value);
+		return true;
+	}
+	return false;
+}
+
+bool T3DReader::ParseUDKRotation(const TCHAR * Stream, FRotator &Rotator)
+{
+	static const TCHAR * const Keys[] = { TEXT("Pitch"), TEXT("Yaw"), TEXT("Roll") };
+	double Values[3] = { 0.0, 0.0, 0.0 };
+
+	const uint32 Found = T3DNumberParser::ParseFields(Stream, Keys, 3, Values);
+
+	// UDK rotations are integers
+	Rotator.Pitch = (int32)Values[0] * UnrRotToDeg;
+	Rotator.Yaw = (int32)Values[1] * UnrRotToDeg;
+	Rotator.Roll = (int32)Values[2] * UnrRotToDeg;
+
+	return Found == 0x7;
+}
+
+bool T3DReader::ParseFVector(const TCHAR* Stream, FVector& Value)
+{
+	return T3DNumberParser::ParseTriple(Stream, Value);
+}
+
+bool T3DReader::IsProperty(FString &PropertyName, FString &Value)
+{
+	if (LineProperty.Key.Len() > 0)
+	{
+		PropertyName = FString(LineProperty.Key.Len(), LineProperty.Key.GetData());
+		Value = FString(LineProperty.Value.Len(), LineProperty.Value.GetData());
+		return true;
+	}
+
+	return false;
+}
+
+bool T3DReader::IsParameter(const FString& Key, int32& index, FString& Value)
+{
+	const int32 NameLen = LineProperty.Name.Len();
+	if (NameLen > 0 && NameLen < LineProperty.Key.Len() && NameLen == Key.Len() && FCString::Strnicmp(LineProperty.Name.GetData(), *Key, NameLen) == 0)
+	{
+		// Key is Name(index), the whole remaining line is the value
+		index = FCString::Atoi(LineProperty.Key.GetData() + NameLen + 1);
+		Value = LineProperty.Key.GetData() + LineProperty.Key.Len() + 1;
+		return true;
+	}
+
+	return false;
+}
+
+void T3DReader::ParseResourceUrl(const FString &Url, FString &Package, FString &Name)
+{
+	int32 PackageIndex, NameIndex;
+
+	PackageIndex = Url.Find(".", ESearchCase::CaseSensitive, ESearchDir::FromStart);
+
+	if (PackageIndex == -1)
+	{
+		Package = Url;
+		Name = FString();
+	}
+	else
+	{
+		Package = Url.Mid(0, PackageIndex);
+		NameIndex = Url.Find(".", ESearchCase::CaseSensitive, ESearchDir::FromEnd);
+		Name = Url.Mid(NameIndex + 1);
+	}
+}
+
+bool T3DReader::ParseResourceUrl(const FString &Url, FString &Type, FString &Package, FString &Name)
+{
+	int32 Index, PackageIndex, NameIndex;
+
+	if (!Url.FindChar('\'', Index) || !Url.EndsWith(TEXT("'")))
+		return false;
+
+	Type = Url.Mid(0, Index);
+	++Index;
+	PackageIndex = Url.Find(".", ESearchCase::CaseSensitive, ESearchDir::FromStart, Index);
+
+	if (PackageIndex == -1)
+	{
+		// Package Name is the current Package
+		Package = this->Package;
+		Name = Url.Mid(Index, Url.Len() - Index - 1);
+	}
+	else
+	{
+		Package = Url.Mid(Index, PackageIndex - Index);
+		NameIndex = Url.Find(".", ESearchCase::CaseSensitive, ESearchDir::FromEnd);
+		Name = Url.Mid(NameIndex + 1, Url.Len() - NameIndex - 2);
+	}
+
+	return true;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+#include "T3DLineReader.h"
+
+/**
+* Cache of the tokenization of a T3D document, stored next to it (.t3dc).
+* Lines are stored as null-terminated UTF-8 with their tokens, followed by the table of Begin/End blocks.
+* Only the tokens and the block structure are cached: lines are still widened and values are still parsed when read.
+* The cache is keyed by the size and date of the source document, like the fingerprints of the export folders,
+* a cache built from another version of the document is ignored.
+*/
+struct T3DPARSERCORE_API T3DLineCache
+{
+	/** Name of the cache of FileName */
+	static FString CacheFileNameFor(const FString &FileName);
+};
+
+/**
+* Reads lines from a memory-mapped cache, tokens are used as stored.
+* Like T3DMappedLineReader, only a window of the lines and of the block table is mapped at a time.
+*/
+class T3DPARSERCORE_API T3DCachedLineReader : public T3DLineReader
+{
+public:
+	virtual ~T3DCachedLineReader();
+
+	/** Maps the cache of FileName, returns null if there is no cache or if it was not built from a document with this size and date */
+	static TUniquePtr<T3DCachedLineReader> Open(const FString &FileName, const FFileStatData &SourceStat);
+
+	virtual bool ReadLine(FStringView &OutLine) override;
+	virtual bool GetLineTokens(FT3DLineTokens &OutTokens) const override;
+	virtual bool SkipBlock(FStringView &OutLine, int32 &SkippedLines) override;
+
+private:
+	/** Mapped part of the cache, moved when a range outside of it is asked for */
+	struct FWindow
+	{
+		TUniquePtr<IMappedFileRegion> Region;
+		int64 Offset = 0;
+		int64 Size = 0;
+
+		/** Maps [Offset, Offset + Size) if it is not already, returns null if the range is outside of [0, End) */
+		const uint8 * Map(IMappedFileHandle &Handle, int64 Offset, int64 Size, int64 End);
+	};
+
+	explicit T3DCachedLineReader(IMappedFileHandle * Handle);
+	bool ReadLineAt(int64 Offset, FStringView &OutLine);
+
+	TUniquePtr<IMappedFileHandle> Handle;
+	FWindow Lines, Blocks;
+	int64 FileSize, LinesEnd, Current, Next;
+	int64 NumBlocks, NextBlock;
+
+	/** Current line, widened to TCHAR, and its tokens */
+	TArray<TCHAR> LineBuffer;
+	FT3DLineTokens Tokens;
+};
+
+/**
+* Forwards the lines of another reader and writes them to the cache.
+* Closed blocks are spilled to a separate file as they close, memory is bounded by the nesting depth of the document.
+* The cache is only kept once the whole document went through, it is discarded if the reader is destroyed before.
+*/
+class T3DPARSERCORE_API T3DCacheWriterLineReader : public T3DLineReader
+{
+public:
+	virtual ~T3DCacheWriterLineReader();
+
+	/** Starts writing the cache of FileName, Source is only taken if the cache can be written */
+	static TUniquePtr<T3DCacheWriterLineReader> Open(TUniquePtr<T3DLineReader> &Source, const FString &FileName, const FFileStatData &SourceStat);
+
+	virtual bool ReadLine(FStringView &OutLine) override;
+	virtual bool GetLineTokens(FT3DLineTokens &OutTokens) const override;
+
+private:
+	T3DCacheWriterLineReader(TUniquePtr<T3DLineReader> &&Source, FArchive * Archive, FArchive * BlocksArchive, const FString &FileName, const FFileStatData &SourceStat);
+	void WriteHeader(int64 LinesEnd);
+	void Finish();
+
+	void Discard();
+
+	TUniquePtr<T3DLineReader> Source;
+	TUniquePtr<FArchive> Archive, BlocksArchive;
+	FString CacheFileName, TempFileName, BlocksFileName;
+	FFileStatData SourceStat;
+	FT3DLineTokens Tokens;
+	bool bFinished;
+
+	/** Begin record offset and line count of the blocks not closed yet */
+	struct FOpenBlock
+	{
+		int64 Begin, Lines;
+	};
+	TArray<FOpenBlock> OpenBlocks;
+	int64 LineCount, NumBlocks;
+};
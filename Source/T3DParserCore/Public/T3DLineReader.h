@@ -0,0 +1,113 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+class FArchive;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/** Key/value token offsets of a line, relative to the start of the line */
+struct FT3DLineTokens
+{
+	int32 KeyLen = 0; // 0 if the line is not a property
+	int32 NameLen = 0;
+	int32 ValueStart = 0;
+	int32 ValueLen = 0;
+	bool bNested = false;
+	bool bQuoted = false;
+};
+
+/**
+* Forward-only cursor over the lines of a T3D document.
+* Lines are handed out trimmed, as views that stay valid until the next call to ReadLine.
+* Views are always null-terminated, so they can still be passed to FParse/FCString.
+*/
+class T3DPARSERCORE_API T3DLineReader
+{
+public:
+	virtual ~T3DLineReader() {}
+
+	/** Moves to the next line, returns false once the end of the document is reached */
+	virtual bool ReadLine(FStringView &OutLine) = 0;
+
+	/** Gives the tokens of the current line, if the reader already knows them */
+	virtual bool GetLineTokens(FT3DLineTokens &OutTokens) const { return false; }
+
+	/** Moves to the End line of the block opened by the current line, if the reader knows where it is */
+	virtual bool SkipBlock(FStringView &OutLine, int32 &SkippedLines) { return false; }
+
+protected:
+	/** Trims the ANSI/UTF-8 line [Start, Stop) of Data and widens it into LineBuffer */
+	static FStringView WidenLine(const uint8 * Data, int64 Start, int64 Stop, TArray<TCHAR> &LineBuffer);
+};
+
+/**
+* Reads lines from a document held in memory.
+* The document is kept in a single buffer, lines are trimmed and null-terminated in place.
+*/
+class T3DPARSERCORE_API T3DStringLineReader : public T3DLineReader
+{
+public:
+	explicit T3DStringLineReader(FString &&Content);
+
+	virtual bool ReadLine(FStringView &OutLine) override;
+
+private:
+	TArray<TCHAR> Buffer;
+	int32 Position;
+};
+
+/**
+* Reads lines from a memory-mapped ANSI/UTF-8 file.
+* Only a window of the file is mapped at a time, the previous window is released when the cursor moves past it.
+*/
+class T3DPARSERCORE_API T3DMappedLineReader : public T3DLineReader
+{
+public:
+	virtual ~T3DMappedLineReader();
+
+	/** Maps FileName, returns null if the file can't be mapped or is UTF-16 encoded */
+	static TUniquePtr<T3DMappedLineReader> Open(const FString &FileName);
+
+	virtual bool ReadLine(FStringView &OutLine) override;
+
+private:
+	explicit T3DMappedLineReader(IMappedFileHandle * Handle);
+	bool MapWindow(int64 Offset, int64 Size);
+
+	TUniquePtr<IMappedFileHandle> Handle;
+	TUniquePtr<IMappedFileRegion> Region;
+	int64 FileSize, RegionOffset, RegionSize, Position;
+
+	/** Current line, widened to TCHAR */
+	TArray<TCHAR> LineBuffer;
+};
+
+/**
+* Reads lines from an ANSI/UTF-8 file in fixed-size chunks.
+* Memory is bounded by the chunk size (or the longest line), not by the size of the file.
+*/
+class T3DPARSERCORE_API T3DStreamLineReader : public T3DLineReader
+{
+public:
+	virtual ~T3DStreamLineReader();
+
+	/** Opens FileName, returns null if the file can't be read or is UTF-16 encoded */
+	static TUniquePtr<T3DStreamLineReader> Open(const FString &FileName);
+
+	virtual bool ReadLine(FStringView &OutLine) override;
+
+private:
+	explicit T3DStreamLineReader(FArchive * Archive);
+	bool ReadChunk();
+
+	TUniquePtr<FArchive> Archive;
+
+	/** Bytes read from the file, [Position, Chunk.Num()) are not consumed yet */
+	TArray<uint8> Chunk;
+	int32 Position;
+
+	/** Current line, widened to TCHAR */
+	TArray<TCHAR> LineBuffer;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+* Locale-independent parsing of the numbers found in T3D values.
+* Values are parsed in place, in a single forward pass, without temporary strings.
+*/
+class T3DPARSERCORE_API T3DNumberParser
+{
+public:
+	/** Parses a decimal number, Stream is moved past it. Returns false, leaving Stream untouched, if there is no number */
+	static bool ParseNumber(const TCHAR * &Stream, double &Value);
+
+	/**
+	* Parses the numeric fields of a struct value such as (X=0,Y=0,Z=0).
+	* Keys are matched case-insensitively, other fields are skipped.
+	* @return mask of the keys that were found, bit N for Keys[N]
+	*/
+	static uint32 ParseFields(const TCHAR * Stream, const TCHAR * const * Keys, int32 NumKeys, double * Values);
+
+	/** Parses a bare triple such as the ORIGIN and VERTEX lines of polygons (x,y,z) */
+	static bool ParseTriple(const TCHAR * Stream, FVector &Value);
+
+	/** Parses (X=,Y=,Z=), same result as FVector::InitFromString */
+	static bool ParseVector(const TCHAR * Stream, FVector &Value);
+
+	/** Parses (R=,G=,B=,A=), same result as FColor::InitFromString */
+	static bool ParseColor(const TCHAR * Stream, FColor &Value);
+
+	/** Parses (R=,G=,B=,A=), same result as FLinearColor::InitFromString */
+	static bool ParseLinearColor(const TCHAR * Stream, FLinearColor &Value);
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+#include "T3DLineReader.h"
+
+/**
+* Navigation and value parsing over the lines of a T3D document.
+* Only depends on Core, so it can be used outside of the editor.
+*/
+class T3DPARSERCORE_API T3DReader
+{
+public:
+	static float UnrRotToDeg;
+
+	/// Key/value record of the current line (eg: Location=(X=0,Y=0,Z=0))
+	struct FLineProperty
+	{
+		FStringView Key; // Text before '=', with the array index if any
+		FStringView Name; // Property name, without the array index
+		FStringView Value; // Value, without surrounding quotes
+		bool bNested = false; // Value is enclosed in parentheses
+		bool bQuoted = false; // Value is enclosed in quotes
+	};
+
+	T3DReader();
+	virtual ~T3DReader() {}
+
+	/// Line parsing
+	int32 LineIndex, ParserLevel;
+	TUniquePtr<T3DLineReader> Reader;
+	FStringView Line;
+	FLineProperty LineProperty;
+	FString Package;
+	bool bUseCache; // Files are read from and tokenized into a .t3dc cache
+	void ResetParser(FString &&Content);
+	bool ResetParserFromFile(const FString &FileName, bool bStreamed = false);
+	bool NextLine();
+	void FinishDocument();
+	bool IgnoreSubs();
+	bool IgnoreSubObjects();
+	void JumpToEnd();
+	void ReadBlock(FString &Block);
+	void TokenizeLine();
+	static void TokenizeLine(FStringView Line, FT3DLineTokens &Tokens);
+
+	/// Line content parsing
+	bool IsBeginObject(FString &Class);
+	bool IsEndObject();
+	bool IsProperty(FString &PropertyName, FString &Value);
+	bool IsParameter(const FString& Key, int32& index, FString& Value);
+
+	/// Value parsing
+	bool GetOneValueAfter(const TCHAR * Key, FString &Value, int32 maxindex = MAX_int32);
+	bool GetProperty(const TCHAR * Key, FString &Value);
+	bool GetProperty(const TCHAR * Key, float &Value);
+	bool GetProperty(const TCHAR * Key, FVector &Value);
+	bool GetProperty(const TCHAR * Key, FRotator &Value);
+	bool GetProperty(const TCHAR * Key, FColor &Value);
+	bool IsPropertyKey(const TCHAR * Key) const;
+	bool ParseUDKRotation(const TCHAR * Stream, FRotator &Rotator);
+	bool ParseFVector(const TCHAR* Stream, FVector& Value);
+	void ParseResourceUrl(const FString &Url, FString &Package, FString &Name);
+	bool ParseResourceUrl(const FString &Url, FString &Type, FString &Package, FString &Name);
+};
+
+FORCEINLINE bool T3DReader::IsPropertyKey(const TCHAR * Key) const
+{
+	const int32 KeyLen = LineProperty.Key.Len();
+	return KeyLen > 0 && FCString::Strncmp(LineProperty.Key.GetData(), Key, KeyLen) == 0 && Key[KeyLen] == 0;
+}
+
+FORCEINLINE bool T3DReader::GetProperty(const TCHAR * Key, FString &Value)
+{
+	if (IsPropertyKey(Key))
+	{
+		Value = FString(LineProperty.Value.Len(), LineProperty.Value.GetData());
+		return true;
+	}
+	return false;
+}
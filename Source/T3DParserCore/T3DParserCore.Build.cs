@@ -0,0 +1,14 @@
+using UnrealBuildTool;
+
+public class T3DParserCore : ModuleRules
+{
+	public T3DParserCore(ReadOnlyTargetRules Target) : base(Target)
+	{
+		// Engine-independent on purpose, the parser must stay usable outside of the editor
+		PublicDependencyModuleNames.AddRange(
+			new string[] {
+				"Core"
+			}
+		);
+	}
+}
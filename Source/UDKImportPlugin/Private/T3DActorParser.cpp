@@ -0,0 +1,332 @@
+#include "T3DActorParser.h"
+
+#include "UDKImportPluginPrivatePCH.h"
+
+bool T3DActorParser::EActorClass::FromName(const FString &Name, Type &Class)
+{
+	if (Name.Equals(TEXT("StaticMeshActor")))
+		Class = StaticMeshActor;
+	else if (Name.Equals(TEXT("Brush")))
+		Class = Brush;
+	else if (Name.Equals(TEXT("PointLight")))
+		Class = PointLight;
+	else if (Name.Equals(TEXT("SpotLight")))
+		Class = SpotLight;
+	else
+		return false;
+
+	return true;
+}
+
+T3DActorParser::T3DActorParser()
+{
+}
+
+void T3DActorParser::ParseActors(TArray<FActorBlock> &Blocks, TArray<FActor> &Actors, EParallelForFlags Flags)
+{
+	Actors.Reset();
+	Actors.SetNum(Blocks.Num());
+
+	const int32 NumTasks = FMath::DivideAndRoundUp(Blocks.Num(), ActorBlocksPerTask);
+	ParallelFor(NumTasks, [&Blocks, &Actors](int32 Task)
+	{
+		T3DActorParser ActorParser;
+		const int32 End = FMath::Min((Task + 1) * ActorBlocksPerTask, Blocks.Num());
+		for (int32 Index = Task * ActorBlocksPerTask; Index < End; ++Index)
+		{
+			ActorParser.ParseActor(MoveTemp(Blocks[Index]), Actors[Index]);
+		}
+	}, Flags);
+	Blocks.Reset();
+}
+
+void T3DActorParser::ParseActor(FActorBlock &&Block, FActor &Actor)
+{
+	Actor.Class = Block.Class;
+
+	ResetParser(MoveTemp(Block.Text));
+	ensure(NextLine());
+
+	switch (Actor.Class)
+	{
+	case EActorClass::StaticMeshActor: ParseStaticMeshActor(Actor); break;
+	case EActorClass::Brush: ParseBrush(Actor); break;
+	case EActorClass::PointLight: ParsePointLight(Actor); break;
+	case EActorClass::SpotLight: ParseSpotLight(Actor); break;
+	}
+}
+
+void T3DActorParser::ParseBrush(FActor &Actor)
+{
+	FString Value;
+
+	while (NextLine() && !IsEndObject())
+	{
+		if (Line.StartsWith(TEXT("Begin Brush ")))
+		{
+			while (NextLine() && !Line.StartsWith(TEXT("End Brush")))
+			{
+				if (Line.StartsWith(TEXT("Begin PolyList")))
+				{
+					ParsePolyList(Actor);
+				}
+			}
+		}
+		else if (GetProperty(TEXT("CsgOper"), Value))
+		{
+			if (Value.Equals(TEXT("CSG_Subtract")))
+			{
+				Actor.bSubtract = true;
+			}
+		}
+		else if (IsActorLocation(Actor) || IsActorProperty(Actor))
+		{
+			continue;
+		}
+		else if (Line.StartsWith(TEXT("Begin "), ESearchCase::CaseSensitive))
+		{
+			JumpToEnd();
+		}
+	}
+}
+
+void T3DActorParser::ParsePolyList(FActor &Actor)
+{
+	FString Texture;
+	while (NextLine() && !Line.StartsWith(TEXT("End PolyList")))
+	{
+		if (Line.StartsWith(TEXT("Begin Polygon ")))
+		{
+			bool GotBase = false;
+			FPoly Poly;
+			const bool bGotTexture = GetOneValueAfter(TEXT(" Texture="), Texture);
+			FParse::Value(Line.GetData(), TEXT("LINK="), Poly.iLink);
+			Poly.PolyFlags &= ~PF_NoImport;
+
+			while (NextLine() && !Line.StartsWith(TEXT("End Polygon")))
+			{
+				const TCHAR* Str = Line.GetData();
+				if (FParse::Command(&Str, TEXT("ORIGIN")))
+				{
+					GotBase = true;
+					ParseFVector(Str, Poly.Base);
+				}
+				else if (FParse::Command(&Str, TEXT("VERTEX")))
+				{
+					FVector TempVertex;
+					ParseFVector(Str, TempVertex);
+					new(Poly.Vertices) FVector(TempVertex);
+				}
+				else if (FParse::Command(&Str, TEXT("TEXTUREU")))
+				{
+					ParseFVector(Str, Poly.TextureU);
+				}
+				else if (FParse::Command(&Str, TEXT("TEXTUREV")))
+				{
+					ParseFVector(Str, Poly.TextureV);
+				}
+				else if (FParse::Command(&Str, TEXT("NORMAL")))
+				{
+					ParseFVector(Str, Poly.Normal);
+				}
+			}
+			if (!GotBase && Poly.Vertices.Num() > 0)
+				Poly.Base = Poly.Vertices[0];
+
+			// Rejected polygons are dropped, the textures index the polygons that were kept
+			if (Poly.Finalize(NULL, 1) == 0)
+			{
+				if (bGotTexture)
+					Actor.PolyTextures.Emplace(Texture, Actor.Polys.Num());
+				Actor.Polys.Add(Poly);
+			}
+		}
+	}
+}
+
+void T3DActorParser::ParsePointLight(FActor &Actor)
+{
+	FString Class;
+	float Number;
+	FColor Color;
+
+	while (NextLine() && !IsEndObject())
+	{
+		if (IsBeginObject(Class))
+		{
+			if (Class.Equals(TEXT("SpotLightComponent")))
+			{
+				while (NextLine() && IgnoreSubs() && !IsEndObject())
+				{
+					if (GetProperty(TEXT("Radius"), Number))
+					{
+						Actor.Radius = Number;
+					}
+					else if (GetProperty(TEXT("Brightness"), Number))
+					{
+						Actor.Brightness = Number;
+					}
+					else if (GetProperty(TEXT("LightColor"), Color))
+					{
+						Actor.LightColor = Color;
+					}
+				}
+			}
+			else
+			{
+				JumpToEnd();
+			}
+		}
+		else if (IsActorLocation(Actor) || IsActorRotation(Actor) || IsActorProperty(Actor))
+		{
+			continue;
+		}
+	}
+}
+
+void T3DActorParser::ParseSpotLight(FActor &Actor)
+{
+	FString Class;
+	float Number;
+	FColor Color;
+	FRotator Rotator;
+	FVector Vector;
+
+	while (NextLine() && !IsEndObject())
+	{
+		if (IsBeginObject(Class))
+		{
+			if (Class.Equals(TEXT("SpotLightComponent")))
+			{
+				while (NextLine() && IgnoreSubs() && !IsEndObject())
+				{
+					if (GetProperty(TEXT("Radius"), Number))
+					{
+						Actor.Radius = Number;
+					}
+					else if (GetProperty(TEXT("InnerConeAngle"), Number))
+					{
+						Actor.InnerConeAngle = Number;
+					}
+					else if (GetProperty(TEXT("OuterConeAngle"), Number))
+					{
+						Actor.OuterConeAngle = Number;
+					}
+					else if (GetProperty(TEXT("Brightness"), Number))
+					{
+						Actor.Brightness = Number;
+					}
+					else if (GetProperty(TEXT("LightColor"), Color))
+					{
+						Actor.LightColor = Color;
+					}
+				}
+			}
+			else
+			{
+				JumpToEnd();
+			}
+		}
+		else if (IsActorLocation(Actor) || IsActorProperty(Actor))
+		{
+			continue;
+		}
+		else if (GetProperty(TEXT("Rotation"), Rotator))
+		{
+			Actor.Rotation = Rotator;
+		}
+		else if (GetProperty(TEXT("DrawScale3D"), Vector))
+		{
+			Actor.Scale3D = Vector;
+		}
+	}
+}
+
+void T3DActorParser::ParseStaticMeshActor(FActor &Actor)
+{
+	FString Value, Class;
+	FVector Vector;
+
+	while (NextLine() && !IsEndObject())
+	{
+		if (IsBeginObject(Class))
+		{
+			if (Class.Equals(TEXT("StaticMeshComponent")))
+			{
+				while (NextLine() && !IsEndObject())
+				{
+					if (GetProperty(TEXT("StaticMesh"), Value))
+					{
+						Actor.StaticMeshes.Add(Value);
+					}
+				}
+			}
+			else
+			{
+				JumpToEnd();
+			}
+		}
+		else if (IsActorLocation(Actor) || IsActorRotation(Actor) || IsActorScale(Actor) || IsActorProperty(Actor))
+		{
+			continue;
+		}
+		else if (GetProperty(TEXT("PrePivot"), Vector))
+		{
+			Actor.PrePivot = Vector;
+		}
+	}
+}
+
+bool T3DActorParser::IsActorLocation(FActor &Actor)
+{
+	FVector Location;
+	if (GetProperty(TEXT("Location"), Location))
+	{
+		Actor.Location = Location;
+		return true;
+	}
+
+	return false;
+}
+
+bool T3DActorParser::IsActorRotation(FActor &Actor)
+{
+	FRotator Rotator;
+	if (GetProperty(TEXT("Rotation"), Rotator))
+	{
+		Actor.Rotation = Rotator;
+		return true;
+	}
+
+	return false;
+}
+
+bool T3DActorParser::IsActorScale(FActor &Actor)
+{
+	float DrawScale;
+	FVector DrawScale3D;
+	if (GetProperty(TEXT("DrawScale"), DrawScale))
+	{
+		Actor.Scale3D = Actor.Scale3D.Get(FVector::OneVector) * DrawScale;
+		return true;
+	}
+	else if (GetProperty(TEXT("DrawScale3D"), DrawScale3D))
+	{
+		Actor.Scale3D = Actor.Scale3D.Get(FVector::OneVector) * DrawScale3D;
+		return true;
+	}
+
+	return false;
+}
+
+bool T3DActorParser::IsActorProperty(FActor &Actor)
+{
+	FString Value;
+	if (GetProperty(TEXT("Layer"), Value))
+	{
+		Actor.Layers.Add(Value);
+		return true;
+	}
+
+	return false;
+}
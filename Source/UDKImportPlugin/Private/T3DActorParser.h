@@ -0,0 +1,80 @@
+#pragma once
+
+#include "T3DReader.h"
+
+#include "Engine/Polys.h"
+#include "Async/ParallelFor.h"
+
+/**
+* Parses a single level actor block into a plain description.
+* Parsing only does text work and holds no editor state, so actor blocks can be parsed from any thread.
+*/
+class T3DActorParser : public T3DReader
+{
+public:
+	struct EActorClass
+	{
+		enum Type
+		{
+			StaticMeshActor,
+			Brush,
+			PointLight,
+			SpotLight
+		};
+
+		/** Tells if actors of the UDK class Name are imported */
+		static bool FromName(const FString &Name, Type &Class);
+	};
+
+	/** Top-level actor block of the level */
+	struct FActorBlock
+	{
+		EActorClass::Type Class;
+		FString Text;
+	};
+
+	/** Everything needed to spawn the actor on the game thread */
+	struct FActor
+	{
+		EActorClass::Type Class;
+
+		TOptional<FVector> Location;
+		TOptional<FRotator> Rotation;
+		TOptional<FVector> Scale3D;
+		TArray<FString> Layers;
+
+		// StaticMeshActor
+		TArray<FString> StaticMeshes;
+		TOptional<FVector> PrePivot;
+
+		// Brush
+		bool bSubtract = false;
+		TArray<FPoly> Polys;
+		TArray<TPair<FString, int32>> PolyTextures; // Material name, index in Polys
+
+		// Lights
+		TOptional<float> Radius, Brightness, InnerConeAngle, OuterConeAngle;
+		TOptional<FColor> LightColor;
+	};
+
+	T3DActorParser();
+
+	/** Parses the actor block into Actor */
+	void ParseActor(FActorBlock &&Block, FActor &Actor);
+
+	/** Parses and empties Blocks into Actors, in the same order, one parser for each task of ActorBlocksPerTask blocks */
+	static void ParseActors(TArray<FActorBlock> &Blocks, TArray<FActor> &Actors, EParallelForFlags Flags = EParallelForFlags::None);
+	static const int32 ActorBlocksPerTask = 32;
+
+private:
+	void ParseStaticMeshActor(FActor &Actor);
+	void ParseBrush(FActor &Actor);
+	void ParsePolyList(FActor &Actor);
+	void ParsePointLight(FActor &Actor);
+	void ParseSpotLight(FActor &Actor);
+
+	bool IsActorLocation(FActor &Actor);
+	bool IsActorRotation(FActor &Actor);
+	bool IsActorScale(FActor &Actor);
+	bool IsActorProperty(FActor &Actor);
+};
@@ -0,0 +1,727 @@
+#include "UDKImportPluginPrivatePCH.h"
+
+#include "Algo/AnyOf.h"
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "ObjectTools.h"
+#include "T3DActorParser.h"
+#include "T3DCorpusGenerator.h"
+#include "T3DLevelParser.h"
+#include "T3DLineCache.h"
+#include "T3DMaterialInstanceConstantParser.h"
+#include "T3DMaterialParser.h"
+#include "T3DNumberParser.h"
+#include "UDKExportSession.h"
+
+/**
+* Parser throughput benchmark over a generated corpus.
+* Usage: UDKImport.Benchmark [Dir=] [Actors=] [Brushes=] [Polygons=] [Lights=] [Components=] [Materials=] [Expressions=] [Instances=] [Seed=] [LinearMax=]
+*/
+namespace T3DBenchmark
+{
+	/** Runs Body, which returns the number of lines it parsed, and logs its throughput */
+	static void RunPhase(const TCHAR * Name, int64 Bytes, TFunctionRef<int64()> Body)
+	{
+		const FPlatformMemoryStats Before = FPlatformMemory::GetStats();
+		const double Start = FPlatformTime::Seconds();
+		const int64 Lines = Body();
+		const double Seconds = FMath::Max(FPlatformTime::Seconds() - Start, 1e-9);
+		const FPlatformMemoryStats After = FPlatformMemory::GetStats();
+
+		UE_LOG(UDKImportPluginLog, Display, TEXT("%-20s %8.3f s %10lld lines %12.0f lines/s %8.2f MB/s, memory %+8.2f MB, peak RSS %8.2f MB"),
+			Name, Seconds, Lines, Lines / Seconds, Bytes / Seconds / (1024.0 * 1024.0),
+			((int64)After.UsedPhysical - (int64)Before.UsedPhysical) / (1024.0 * 1024.0), After.PeakUsedPhysical / (1024.0 * 1024.0));
+	}
+
+	static const TCHAR * const BenchmarkPackage = TEXT("UDKImportBenchmark");
+
+	/** Full names of the T3D files of Folder, Bytes is their total size */
+	static TArray<FString> FindFiles(const FString &Folder, int64 &Bytes)
+	{
+		TArray<FString> FileNames;
+		IFileManager::Get().FindFiles(FileNames, *(Folder / TEXT("*.T3D")), true, false);
+
+		Bytes = 0;
+		for (FString &FileName : FileNames)
+		{
+			FileName = Folder / FileName;
+			Bytes += IFileManager::Get().FileSize(*FileName);
+		}
+		return FileNames;
+	}
+
+	static int64 ReadLines(const FString &FileName, bool bStreamed, bool bUseCache = false)
+	{
+		T3DReader Reader;
+		Reader.bUseCache = bUseCache;
+		if (!Reader.ResetParserFromFile(FileName, bStreamed))
+			return 0;
+
+		while (Reader.NextLine())
+		{
+		}
+		return Reader.LineIndex;
+	}
+
+	/// Copies of the original parser, kept to compare the old and new paths on the same corpus
+
+	static bool IsOriginalWhitespace(TCHAR c)
+	{
+		return c == TCHAR(' ') || c == TCHAR('\t') || c == TCHAR('\r');
+	}
+
+	/** Line cursor of the original parser: the file as one string, split into one FString per line, copied again when visited */
+	static int64 ReadLinesOriginal(const FString &FileName)
+	{
+		FString Content;
+		if (!FFileHelper::LoadFileToString(Content, *FileName))
+			return 0;
+
+		TArray<FString> Lines;
+		Content.ParseIntoArray(Lines, TEXT("\n"), true);
+
+		int64 Count = 0;
+		for (const FString &String : Lines)
+		{
+			int32 Start = 0, End = String.Len();
+			while (Start < End && IsOriginalWhitespace(String[Start]))
+			{
+				++Start;
+			}
+			while (End > Start && IsOriginalWhitespace(String[End - 1]))
+			{
+				--End;
+			}
+
+			const FString Line = String.Mid(Start, End - Start);
+			++Count;
+		}
+		return Count;
+	}
+
+	/** GetProperty of the original parser, the whole line is searched for each key */
+	static bool GetPropertyOriginal(const TCHAR * Line, const FString &Key, FString &Value)
+	{
+		const TCHAR * Found = FCString::Strstr(Line, *Key);
+		if (Found != Line)
+			return false;
+
+		const TCHAR * Start = Found + Key.Len();
+		const TCHAR * Buffer = Start;
+		if (*Buffer == TCHAR('"'))
+		{
+			++Start;
+			++Buffer;
+			bool Escaping = false;
+			while (*Buffer && (*Buffer != TCHAR('"') || Escaping))
+			{
+				if (Escaping)
+					Escaping = false;
+				else if (*Buffer == TCHAR('\\'))
+					Escaping = true;
+				++Buffer;
+			}
+		}
+		else if (*Buffer == TCHAR('('))
+		{
+			++Buffer;
+			int Level = 1;
+			while (*Buffer && Level != 0)
+			{
+				if (*Buffer == TCHAR('('))
+					++Level;
+				else if (*Buffer == TCHAR(')'))
+					--Level;
+				++Buffer;
+			}
+		}
+		else
+		{
+			while (*Buffer && *Buffer != TCHAR(' ') && *Buffer != TCHAR(',') && *Buffer != TCHAR(')'))
+			{
+				++Buffer;
+			}
+		}
+		Value = FString((int32)(Buffer - Start), Start);
+		return true;
+	}
+
+	/** Keys the actor importers test on each line, in their order */
+	static const TCHAR * const ActorKeys[] = { TEXT("Location"), TEXT("Rotation"), TEXT("DrawScale"), TEXT("DrawScale3D"), TEXT("Layer"), TEXT("PrePivot"), TEXT("StaticMesh"), TEXT("Radius"), TEXT("Brightness"), TEXT("LightColor") };
+	static const TCHAR * const OriginalActorKeys[] = { TEXT("Location="), TEXT("Rotation="), TEXT("DrawScale="), TEXT("DrawScale3D="), TEXT("Layer="), TEXT("PrePivot="), TEXT("StaticMesh="), TEXT("Radius="), TEXT("Brightness="), TEXT("LightColor=") };
+
+	/** Dispatches each line of the level on ActorKeys as the original importers did, one search of the line per key */
+	static int64 MatchActorKeysOriginal(const FString &FileName, int64 &Matches)
+	{
+		T3DReader Reader;
+		Reader.bUseCache = false;
+		if (!Reader.ResetParserFromFile(FileName))
+			return 0;
+
+		// Lines are read without the tokenizer, the original parser had none
+		int64 Lines = 0;
+		FStringView Line;
+		FString Value;
+		while (Reader.Reader->ReadLine(Line))
+		{
+			++Lines;
+			for (const TCHAR * Key : OriginalActorKeys)
+			{
+				if (GetPropertyOriginal(Line.GetData(), Key, Value))
+				{
+					++Matches;
+					break;
+				}
+			}
+		}
+		return Lines;
+	}
+
+	/** Dispatches each line of the level on ActorKeys through the tokenized key/value record */
+	static int64 MatchActorKeys(const FString &FileName, int64 &Matches)
+	{
+		T3DReader Reader;
+		Reader.bUseCache = false;
+		if (!Reader.ResetParserFromFile(FileName))
+			return 0;
+
+		FString Value;
+		while (Reader.NextLine())
+		{
+			for (const TCHAR * Key : ActorKeys)
+			{
+				if (Reader.GetProperty(Key, Value))
+				{
+					++Matches;
+					break;
+				}
+			}
+		}
+		return Reader.LineIndex;
+	}
+
+	/** Numeric values of the level, with the parser they go through */
+	struct FNumberValue
+	{
+		enum EKind { Vector, Rotator, Color, Triple } Kind;
+		FString Text;
+	};
+
+	/** Collects the vectors, rotators, colors and polygon triples of the level, up to MaxValues */
+	static int64 CollectNumberValues(const FString &FileName, int32 MaxValues, TArray<FNumberValue> &Values)
+	{
+		T3DReader Reader;
+		Reader.bUseCache = false;
+		if (!Reader.ResetParserFromFile(FileName))
+			return 0;
+
+		static const TCHAR * const TripleCommands[] = { TEXT("ORIGIN"), TEXT("VERTEX"), TEXT("TEXTUREU"), TEXT("TEXTUREV"), TEXT("NORMAL") };
+		int64 Bytes = 0;
+		while (Values.Num() < MaxValues && Reader.NextLine())
+		{
+			FNumberValue Value;
+			const TCHAR * Stream = Reader.Line.GetData();
+			if (Reader.IsPropertyKey(TEXT("Location")) || Reader.IsPropertyKey(TEXT("DrawScale3D")) || Reader.IsPropertyKey(TEXT("PrePivot")))
+				Value.Kind = FNumberValue::Vector;
+			else if (Reader.IsPropertyKey(TEXT("Rotation")))
+				Value.Kind = FNumberValue::Rotator;
+			else if (Reader.IsPropertyKey(TEXT("LightColor")))
+				Value.Kind = FNumberValue::Color;
+			else if (Algo::AnyOf(TripleCommands, [&Stream](const TCHAR * Command) { return FParse::Command(&Stream, Command); }))
+				Value.Kind = FNumberValue::Triple;
+			else
+				continue;
+
+			Value.Text = Value.Kind == FNumberValue::Triple ? FString(Reader.Line.Len() - int32(Stream - Reader.Line.GetData()), Stream) : FString(Reader.LineProperty.Value.Len(), Reader.LineProperty.Value.GetData());
+			Bytes += Value.Text.Len();
+			Values.Add(MoveTemp(Value));
+		}
+		return Bytes;
+	}
+
+	/** ParseFVector of the original parser, Atof and Strchr for each component */
+	static bool ParseFVectorOriginal(const TCHAR * Stream, FVector &Value)
+	{
+		Value = FVector::ZeroVector;
+
+		Value.X = FCString::Atof(Stream);
+		Stream = FCString::Strchr(Stream, ',');
+		if (!Stream)
+			return false;
+
+		Stream++;
+		Value.Y = FCString::Atof(Stream);
+		Stream = FCString::Strchr(Stream, ',');
+		if (!Stream)
+			return false;
+
+		Stream++;
+		Value.Z = FCString::Atof(Stream);
+		return true;
+	}
+
+	/** ParseUDKRotation of the original parser, one FParse::Value scan for each component */
+	static bool ParseUDKRotationOriginal(const FString &InSourceString, FRotator &Rotator)
+	{
+		int32 Pitch = 0;
+		int32 Yaw = 0;
+		int32 Roll = 0;
+
+		const bool bSuccessful = FParse::Value(*InSourceString, TEXT("Pitch="), Pitch) && FParse::Value(*InSourceString, TEXT("Yaw="), Yaw) && FParse::Value(*InSourceString, TEXT("Roll="), Roll);
+
+		Rotator.Pitch = Pitch * T3DReader::UnrRotToDeg;
+		Rotator.Yaw = Yaw * T3DReader::UnrRotToDeg;
+		Rotator.Roll = Roll * T3DReader::UnrRotToDeg;
+		return bSuccessful;
+	}
+
+	/** Parses Values with the functions of the original parser, or with T3DNumberParser */
+	static int64 ParseNumberValues(const TArray<FNumberValue> &Values, bool bOriginal, TArray<FVector4> &Results)
+	{
+		T3DReader Reader;
+		Results.SetNumUninitialized(Values.Num());
+		for (int32 Index = 0; Index < Values.Num(); ++Index)
+		{
+			const FNumberValue &Value = Values[Index];
+			FVector Vector = FVector::ZeroVector;
+			FRotator Rotator = FRotator::ZeroRotator;
+			FColor Color = FColor::Black;
+			switch (Value.Kind)
+			{
+			case FNumberValue::Vector:
+				if (bOriginal)
+					Vector.InitFromString(Value.Text);
+				else
+					T3DNumberParser::ParseVector(*Value.Text, Vector);
+				Results[Index] = FVector4(Vector, 0.f);
+				break;
+			case FNumberValue::Rotator:
+				if (bOriginal)
+					ParseUDKRotationOriginal(Value.Text, Rotator);
+				else
+					Reader.ParseUDKRotation(*Value.Text, Rotator);
+				Results[Index] = FVector4(Rotator.Pitch, Rotator.Yaw, Rotator.Roll, 0.f);
+				break;
+			case FNumberValue::Color:
+				if (bOriginal)
+					Color.InitFromString(Value.Text);
+				else
+					T3DNumberParser::ParseColor(*Value.Text, Color);
+				Results[Index] = FVector4(Color.R, Color.G, Color.B, Color.A);
+				break;
+			case FNumberValue::Triple:
+				if (bOriginal)
+					ParseFVectorOriginal(*Value.Text, Vector);
+				else
+					T3DNumberParser::ParseTriple(*Value.Text, Vector);
+				Results[Index] = FVector4(Vector, 0.f);
+				break;
+			}
+		}
+		return Values.Num();
+	}
+
+	/** Reads the actor blocks of the level in batches of BatchSize characters, as the level importer does */
+	static int64 ReadActorBlocks(const FString &FileName, int32 BatchSize, TFunctionRef<bool(TArray<T3DActorParser::FActorBlock>&)> OnBatch)
+	{
+		T3DReader Reader;
+		Reader.bUseCache = false;
+		if (!Reader.ResetParserFromFile(FileName, true))
+			return 0;
+
+		FString Class;
+		TArray<T3DActorParser::FActorBlock> Blocks;
+		int32 BlocksSize = 0;
+		Reader.NextLine();
+		while (Reader.NextLine() && !Reader.IsEndObject())
+		{
+			if (Reader.IsBeginObject(Class))
+			{
+				T3DActorParser::EActorClass::Type ActorClass;
+				if (T3DActorParser::EActorClass::FromName(Class, ActorClass))
+				{
+					T3DActorParser::FActorBlock& Block = Blocks.AddDefaulted_GetRef();
+					Block.Class = ActorClass;
+					Reader.ReadBlock(Block.Text);
+
+					BlocksSize += Block.Text.Len();
+					if (BlocksSize >= BatchSize)
+					{
+						if (!OnBatch(Blocks))
+							return Reader.LineIndex;
+						Blocks.Reset();
+						BlocksSize = 0;
+					}
+				}
+				else
+				{
+					Reader.JumpToEnd();
+				}
+			}
+		}
+		OnBatch(Blocks);
+
+		return Reader.LineIndex;
+	}
+
+	static int64 ParseActors(const FString &FileName)
+	{
+		TArray<T3DActorParser::FActor> Actors;
+		return ReadActorBlocks(FileName, 16 * 1024 * 1024, [&Actors](TArray<T3DActorParser::FActorBlock> &Blocks)
+		{
+			T3DActorParser::ParseActors(Blocks, Actors);
+			return true;
+		});
+	}
+
+	static bool IsSameActor(const T3DActorParser::FActor &A, const T3DActorParser::FActor &B)
+	{
+		if (A.Polys.Num() != B.Polys.Num())
+			return false;
+
+		for (int32 Index = 0; Index < A.Polys.Num(); ++Index)
+		{
+			const FPoly &PolyA = A.Polys[Index], &PolyB = B.Polys[Index];
+			if (PolyA.Base != PolyB.Base || PolyA.Normal != PolyB.Normal || PolyA.TextureU != PolyB.TextureU || PolyA.TextureV != PolyB.TextureV || PolyA.Vertices != PolyB.Vertices)
+				return false;
+		}
+
+		return A.Class == B.Class && A.Location == B.Location && A.Rotation == B.Rotation && A.Scale3D == B.Scale3D && A.Layers == B.Layers
+			&& A.StaticMeshes == B.StaticMeshes && A.PrePivot == B.PrePivot && A.bSubtract == B.bSubtract && A.PolyTextures == B.PolyTextures
+			&& A.Radius == B.Radius && A.Brightness == B.Brightness && A.InnerConeAngle == B.InnerConeAngle && A.OuterConeAngle == B.OuterConeAngle && A.LightColor == B.LightColor;
+	}
+
+	/** Parses the first batch of actor blocks on 1, 2, 4... threads, up to the number of cores, and logs the speedup over one thread and any difference with the serial parse */
+	static void RunActorScaling(const FString &FileName)
+	{
+		TArray<T3DActorParser::FActorBlock> Blocks;
+		ReadActorBlocks(FileName, 64 * 1024 * 1024, [&Blocks](TArray<T3DActorParser::FActorBlock> &Batch)
+		{
+			Blocks = MoveTemp(Batch);
+			return false;
+		});
+
+		int64 Bytes = 0;
+		for (const T3DActorParser::FActorBlock &Block : Blocks)
+		{
+			Bytes += Block.Text.Len();
+		}
+
+		// The original importer parsed straight into spawned actors, the reference is the importer's own parse on the calling thread only
+		TArray<T3DActorParser::FActor> SerialActors;
+		{
+			TArray<T3DActorParser::FActorBlock> SerialBlocks = Blocks;
+			T3DActorParser::ParseActors(SerialBlocks, SerialActors, EParallelForFlags::ForceSingleThread);
+		}
+
+		const int32 NumTasks = FMath::DivideAndRoundUp(Blocks.Num(), T3DActorParser::ActorBlocksPerTask);
+		const int32 MaxThreads = FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+		double SerialSeconds = 0.0;
+		for (int32 Threads = 1; Threads <= MaxThreads; Threads = Threads < MaxThreads ? FMath::Min(Threads * 2, MaxThreads) : MaxThreads + 1)
+		{
+			// Same tasks as T3DActorParser::ParseActors, on exactly Threads threads
+			TArray<T3DActorParser::FActor> Actors;
+			Actors.SetNum(Blocks.Num());
+			FThreadSafeCounter NextTask;
+			TArray<TFuture<void>> Workers;
+
+			const double Start = FPlatformTime::Seconds();
+			for (int32 Thread = 0; Thread < Threads; ++Thread)
+			{
+				Workers.Add(Async(EAsyncExecution::Thread, [&Blocks, &Actors, &NextTask, NumTasks]()
+				{
+					T3DActorParser ActorParser;
+					for (int32 Task = NextTask.Increment() - 1; Task < NumTasks; Task = NextTask.Increment() - 1)
+					{
+						const int32 End = FMath::Min((Task + 1) * T3DActorParser::ActorBlocksPerTask, Blocks.Num());
+						for (int32 Index = Task * T3DActorParser::ActorBlocksPerTask; Index < End; ++Index)
+						{
+							T3DActorParser::FActorBlock Block = Blocks[Index];
+							ActorParser.ParseActor(MoveTemp(Block), Actors[Index]);
+						}
+					}
+				}));
+			}
+			for (TFuture<void> &Worker : Workers)
+			{
+				Worker.Wait();
+			}
+			const double Seconds = FMath::Max(FPlatformTime::Seconds() - Start, 1e-9);
+
+			if (Threads == 1)
+				SerialSeconds = Seconds;
+
+			bool bIdentical = SerialActors.Num() == Actors.Num();
+			for (int32 Index = 0; Index < Actors.Num() && bIdentical; ++Index)
+			{
+				bIdentical = IsSameActor(SerialActors[Index], Actors[Index]);
+			}
+
+			UE_LOG(UDKImportPluginLog, Display, TEXT("Level actors, %2d threads %8.3f s %10d actors %8.2f MB/s, speedup %5.2fx%s"),
+				Threads, Seconds, Blocks.Num(), Bytes * sizeof(TCHAR) / Seconds / (1024.0 * 1024.0), SerialSeconds / Seconds,
+				bIdentical ? TEXT("") : TEXT(", differs from the serial parse"));
+		}
+	}
+
+	/** Requirement registry workload of a level: each requirement is referenced several times, then fixed once */
+	class FRequirementScaling : public T3DParser
+	{
+	public:
+		FRequirementScaling(int32 NumRequirements) : T3DParser(FString(), FString())
+		{
+			// Four references per requirement, in a shuffled order like actors of a level
+			FRandomStream Random(NumRequirements);
+			for (int32 Index = 0; Index < NumRequirements; ++Index)
+			{
+				Urls.Add(FString::Printf(TEXT("StaticMesh'Benchmark.Meshes.SM_%d'"), Index));
+			}
+			for (int32 Index = 0; Index < NumRequirements * 4; ++Index)
+			{
+				References.Add(Random.RandHelper(NumRequirements));
+			}
+		}
+
+		/** Indexed registry of T3DParser */
+		int64 RunIndexed()
+		{
+			for (int32 Reference : References)
+			{
+				AddRequirement(Urls[Reference], UObjectDelegate::CreateLambda([](UObject * Object) {}));
+			}
+			for (const FString &Url : Urls)
+			{
+				FixRequirement(Url, GetTransientPackage());
+			}
+			return References.Num() + Urls.Num();
+		}
+
+		/** Registry of the original parser, a plain array searched by Url on every add and fix */
+		int64 RunLinear()
+		{
+			TArray<TPair<FRequirement, FRequirementFixups>> List;
+			auto Find = [&List](const FRequirement &Requirement)
+			{
+				return List.FindByPredicate([&Requirement](const TPair<FRequirement, FRequirementFixups> &Pair) { return Pair.Key == Requirement; });
+			};
+
+			for (int32 Reference : References)
+			{
+				FRequirement Requirement;
+				ParseResourceUrl(Urls[Reference], Requirement);
+				if (TPair<FRequirement, FRequirementFixups> * Pair = Find(Requirement))
+					Pair->Value.Actions.Add(UObjectDelegate::CreateLambda([](UObject * Object) {}));
+				else
+					List.Emplace(Requirement, FRequirementFixups()).Value.Actions.Add(UObjectDelegate::CreateLambda([](UObject * Object) {}));
+			}
+			for (const FString &Url : Urls)
+			{
+				FRequirement Requirement;
+				ParseResourceUrl(Url, Requirement);
+				if (TPair<FRequirement, FRequirementFixups> * Pair = Find(Requirement))
+				{
+					for (const UObjectDelegate &Action : Pair->Value.Actions)
+						Action.ExecuteIfBound(GetTransientPackage());
+					Pair->Value.ResolvedObject = GetTransientPackage();
+				}
+			}
+			return References.Num() + Urls.Num();
+		}
+
+	private:
+		TArray<FString> Urls;
+		TArray<int32> References;
+	};
+
+	/** Requirement registry at 1k, 10k and 100k requirements, against the original linear scan up to LinearMax requirements */
+	static void RunRequirementScaling(int32 LinearMax)
+	{
+		const int32 Sizes[] = { 1000, 10000, 100000 };
+		for (int32 NumRequirements : Sizes)
+		{
+			RunPhase(*FString::Printf(TEXT("Requirements %dk"), NumRequirements / 1000), 0, [NumRequirements]()
+			{
+				return FRequirementScaling(NumRequirements).RunIndexed();
+			});
+
+			if (NumRequirements <= LinearMax)
+			{
+				RunPhase(*FString::Printf(TEXT("Requirements %dk, old"), NumRequirements / 1000), 0, [NumRequirements]()
+				{
+					return FRequirementScaling(NumRequirements).RunLinear();
+				});
+			}
+		}
+	}
+
+	static void Run(const TArray<FString> &Args)
+	{
+		const FString Params = FString::Join(Args, TEXT(" "));
+
+		T3DCorpusGenerator::FSettings Settings;
+		FParse::Value(*Params, TEXT("Actors="), Settings.StaticMeshActors);
+		FParse::Value(*Params, TEXT("Brushes="), Settings.Brushes);
+		FParse::Value(*Params, TEXT("Polygons="), Settings.PolygonsPerBrush);
+		FParse::Value(*Params, TEXT("Components="), Settings.NestedComponents);
+		FParse::Value(*Params, TEXT("Materials="), Settings.Materials);
+		FParse::Value(*Params, TEXT("Expressions="), Settings.ExpressionsPerMaterial);
+		FParse::Value(*Params, TEXT("Instances="), Settings.MaterialInstanceConstants);
+		FParse::Value(*Params, TEXT("Seed="), Settings.Seed);
+
+		int32 Lights;
+		if (FParse::Value(*Params, TEXT("Lights="), Lights))
+		{
+			Settings.PointLights = Lights / 2;
+			Settings.SpotLights = Lights - Settings.PointLights;
+		}
+
+		FString Directory = FPaths::ProjectSavedDir() / TEXT("UDKImportBenchmark");
+		FParse::Value(*Params, TEXT("Dir="), Directory);
+
+		int32 LinearMax = 10000;
+		FParse::Value(*Params, TEXT("LinearMax="), LinearMax);
+
+		T3DCorpusGenerator Generator(Settings);
+		RunPhase(TEXT("Generate"), 0, [&]()
+		{
+			return Generator.Generate(Directory) ? 0 : -1;
+		});
+
+		const FString LevelFileName = Directory / TEXT("PersistentLevel.T3D");
+		const int64 LevelBytes = IFileManager::Get().FileSize(*LevelFileName);
+		if (LevelBytes <= 0)
+		{
+			UE_LOG(UDKImportPluginLog, Error, TEXT("Unable to generate the corpus in %s"), *Directory);
+			return;
+		}
+		UE_LOG(UDKImportPluginLog, Display, TEXT("Corpus: %s, %lld bytes"), *Directory, Generator.GetGeneratedBytes());
+
+		RunPhase(TEXT("Level lines, old"), LevelBytes, [&]() { return ReadLinesOriginal(LevelFileName); });
+		RunPhase(TEXT("Level lines, mapped"), LevelBytes, [&]() { return ReadLines(LevelFileName, false); });
+		RunPhase(TEXT("Level lines, stream"), LevelBytes, [&]() { return ReadLines(LevelFileName, true); });
+		IFileManager::Get().Delete(*T3DLineCache::CacheFileNameFor(LevelFileName));
+		RunPhase(TEXT("Level lines, to cache"), LevelBytes, [&]() { return ReadLines(LevelFileName, false, true); });
+		RunPhase(TEXT("Level lines, cached"), LevelBytes, [&]() { return ReadLines(LevelFileName, false, true); });
+		int64 OriginalMatches = 0, Matches = 0;
+		RunPhase(TEXT("Level keys, old"), LevelBytes, [&]() { return MatchActorKeysOriginal(LevelFileName, OriginalMatches); });
+		RunPhase(TEXT("Level keys"), LevelBytes, [&]() { return MatchActorKeys(LevelFileName, Matches); });
+		if (OriginalMatches != Matches)
+		{
+			UE_LOG(UDKImportPluginLog, Warning, TEXT("Level keys: %lld properties matched, %lld by the original parser"), Matches, OriginalMatches);
+		}
+
+		TArray<FNumberValue> NumberValues;
+		const int64 NumberBytes = CollectNumberValues(LevelFileName, 4 * 1024 * 1024, NumberValues) * sizeof(TCHAR);
+		TArray<FVector4> OriginalNumbers, Numbers;
+		RunPhase(TEXT("Level numbers, old"), NumberBytes, [&]() { return ParseNumberValues(NumberValues, true, OriginalNumbers); });
+		RunPhase(TEXT("Level numbers"), NumberBytes, [&]() { return ParseNumberValues(NumberValues, false, Numbers); });
+		int32 NumberMismatches = 0;
+		for (int32 Index = 0; Index < Numbers.Num(); ++Index)
+		{
+			NumberMismatches += Numbers[Index] != OriginalNumbers[Index];
+		}
+		if (NumberMismatches > 0)
+		{
+			UE_LOG(UDKImportPluginLog, Warning, TEXT("Level numbers: %d of %d values differ from the original parser"), NumberMismatches, Numbers.Num());
+		}
+		NumberValues.Empty();
+
+		RunPhase(TEXT("Level actors"), LevelBytes, [&]() { return ParseActors(LevelFileName); });
+		RunActorScaling(LevelFileName);
+
+		// The real parsers create their assets in /Game/UDK/UDKImportBenchmark, they are deleted after each phase
+		T3DLevelParser LevelParser(FString(), Directory);
+		TArray<UObject*> Assets;
+		int64 Bytes;
+
+		TArray<FString> MaterialFileNames = FindFiles(Directory / TEXT("ExportedMaterials"), Bytes);
+		RunPhase(TEXT("Materials"), Bytes, [&]()
+		{
+			int64 Lines = 0;
+			for (const FString &FileName : MaterialFileNames)
+			{
+				T3DMaterialParser MaterialParser(&LevelParser, BenchmarkPackage);
+				MaterialParser.bUseCache = false;
+				if (UMaterial * Material = MaterialParser.ImportMaterialT3DFile(FileName))
+					Assets.Add(Material);
+				Lines += MaterialParser.LineIndex;
+			}
+			return Lines;
+		});
+		ObjectTools::ForceDeleteObjects(Assets, false);
+		Assets.Reset();
+
+		TArray<FString> InstanceFileNames = FindFiles(Directory / TEXT("ExportedMaterialInstances"), Bytes);
+		RunPhase(TEXT("MaterialInstances"), Bytes, [&]()
+		{
+			int64 Lines = 0;
+			for (const FString &FileName : InstanceFileNames)
+			{
+				T3DMaterialInstanceConstantParser MaterialInstanceConstantParser(&LevelParser, BenchmarkPackage);
+				MaterialInstanceConstantParser.bUseCache = false;
+				if (UMaterialInstanceConstant * MaterialInstanceConstant = MaterialInstanceConstantParser.ImportT3DFile(FileName))
+					Assets.Add(MaterialInstanceConstant);
+				Lines += MaterialInstanceConstantParser.LineIndex;
+			}
+			return Lines;
+		});
+		ObjectTools::ForceDeleteObjects(Assets, false);
+
+		RunRequirementScaling(LinearMax);
+	}
+
+	/**
+	* Export server client throughput, against the stand-in server unless another one is given.
+	* Usage: UDKImport.BenchmarkExportServer [Executable=] [Params=] [Requests=] [Window=], Window=0 does not limit the requests in flight
+	*/
+	static void RunExportServer(const TArray<FString> &Args)
+	{
+		const FString Params = FString::Join(Args, TEXT(" "));
+
+		FString Executable = TEXT("python3");
+		FString ServerParams = FPaths::ConvertRelativePathToFull(IPluginManager::Get().FindPlugin(TEXT("UDKImportPlugin"))->GetBaseDir() / TEXT("UDKPluginExport/ExportServerStandIn.py"));
+		int32 Requests = 10000;
+		int32 Window = 0;
+		FParse::Value(*Params, TEXT("Executable="), Executable);
+		FParse::Value(*Params, TEXT("Params="), ServerParams);
+		FParse::Value(*Params, TEXT("Requests="), Requests);
+		FParse::Value(*Params, TEXT("Window="), Window);
+
+		UDKExportSession Session(Executable, ServerParams);
+		if (!Session.Start())
+			return;
+
+		// Half exports, half mesh material queries, like a level import
+		int64 DataLines = 0;
+		int32 Failures = 0;
+		const UDKExportSession::FOnDone OnDone = UDKExportSession::FOnDone::CreateLambda([&Failures](int32 ReturnCode) { Failures += ReturnCode != 0; });
+		const UDKExportSession::FOnData OnData = UDKExportSession::FOnData::CreateLambda([&DataLines](const FString &Data) { ++DataLines; });
+		RunPhase(TEXT("Export server"), 0, [&]()
+		{
+			for (int32 Index = 0; Index < Requests; ++Index)
+			{
+				if (Index % 2)
+					Session.Send(FString::Printf(TEXT("meshmaterials StaticMesh'Bench.Meshes.SM_%d'"), Index), OnDone, OnData);
+				else
+					Session.Send(FString::Printf(TEXT("export Bench_%d|Material|T3D|Exported"), Index), OnDone);
+
+				if (Window > 0)
+					Session.Wait(Window - 1);
+			}
+			Session.Wait();
+			return (int64)Requests;
+		});
+
+		UE_LOG(UDKImportPluginLog, Display, TEXT("Export server: %d requests, %lld data lines, %d failures, window %d"), Requests, DataLines, Failures, Window);
+	}
+
+	static FAutoConsoleCommand Command(
+		TEXT("UDKImport.Benchmark"),
+		TEXT("Generates a synthetic T3D corpus and measures the parser throughput of each phase"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&Run));
+
+	static FAutoConsoleCommand ExportServerCommand(
+		TEXT("UDKImport.BenchmarkExportServer"),
+		TEXT("Measures the request throughput of the export server client"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunExportServer));
+}
@@ -6,18 +6,62 @@
 #include "Runtime/Engine/Classes/Sound/SoundNode.h"
 #include "Runtime/Landscape/Classes/Landscape.h"
 #include "Engine/StaticMeshActor.h"
+#include "Layers/LayersSubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "MaterialShared.h"
+#include "ShaderCompiler.h"
 
 #include "T3DMaterialParser.h"
 #include "T3DMaterialInstanceConstantParser.h"
+#include "UDKExportSession.h"
 
 #ifdef _MSC_VER
 // Declaration of 'x' hides class member
 #pragma warning (disable: 4458)
 #endif
 
-T3DLevelParser::T3DLevelParser(const FString &UdkPath, const FString &TmpPath) : T3DParser(UdkPath, TmpPath)
+// UDK copies its command line into a 16384 characters buffer
+static const int32 MaxUDKCommandLine = 16000;
+
+// Written in an export folder once its package was exported, with the path, size and time of the package
+static const TCHAR * ExportFingerprintName = TEXT("UDKImport.fingerprint");
+
+// Kept in TmpPath, maps each imported requirement to its asset and to the fingerprint of its package
+static const TCHAR * ImportManifestName = TEXT("UDKImport.manifest");
+
+// Fingerprint of a package without file, it never matches a recorded one
+static const TCHAR * UnknownPackageFingerprint = TEXT("Unknown package");
+
+static TAutoConsoleVariable<int32> CVarSelectiveExport(
+	TEXT("UDKImport.SelectiveExport"),
+	1,
+	TEXT("Exports only the required objects of a package instead of the whole package"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarDiscoverDependencies(
+	TEXT("UDKImport.DiscoverDependencies"),
+	1,
+	TEXT("Walks the references of the required assets in UDK before any export, instead of finding them one phase at a time"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarBatchMaterialCompilation(
+	TEXT("UDKImport.BatchMaterialCompilation"),
+	1,
+	TEXT("Compiles the imported Materials and MaterialInstanceConstants together and waits once, instead of one PostEditChange each"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarMeshListFile(
+	TEXT("UDKImport.MeshListFile"),
+	1,
+	TEXT("StaticMesh material queries read their meshes from UDKGame/Config/UDKPluginExport.ini instead of the command line"),
+	ECVF_Default);
+
+T3DLevelParser::T3DLevelParser(const FString &UdkPath, const FString &TmpPath) : T3DParser(UdkPath, TmpPath), ExportPool(GetUDKExecutable())
 {
 	this->World = NULL;
+	this->UDKOutputCount = 0;
+	this->bPackageFilesIndexed = false;
+	this->bImportManifestLoaded = false;
 }
 
 UWorld* T3DLevelParser::GetWorld()
@@ -54,13 +98,12 @@ void T3DLevelParser::ImportLevel(const FString &Level)
 
 	Task.EnterProgressFrame(1.f, LOCTEXT("LoadUDKLevelT3D", "Loading UDK Level information"));
 	{
-		FString UdkLevelT3D;
-		if (!FFileHelper::LoadFileToString(UdkLevelT3D, *(TmpPath / TEXT("PersistentLevel.T3D"))))
+		// The level is streamed, actors are imported as soon as their block has been read
+		if (!ResetParserFromFile(TmpPath / TEXT("PersistentLevel.T3D"), true))
 		{
 			return;
 		}
 
-		ResetParser(UdkLevelT3D);
 		Package = Level;
 	}
 
@@ -159,35 +202,319 @@ void T3DLevelParser::ExportPackageToRequirements(const FString &Package, EExport
 	}
 }
 
+bool T3DLevelParser::ExportFormatFor(EExportType::Type Type, FString &Class, FString &Format)
+{
+	switch (Type)
+	{
+	case EExportType::Material: Class = TEXT("Material"); Format = TEXT("T3D"); break;
+	case EExportType::StaticMesh: Class = TEXT("StaticMesh"); Format = TEXT("FBX"); break;
+	case EExportType::MaterialInstanceConstant: Class = TEXT("MaterialInstanceConstant"); Format = TEXT("T3D"); break;
+	case EExportType::Texture2D: Class = TEXT("Texture"); Format = TEXT("TGA"); break;
+	case EExportType::Texture2DInfo: Class = TEXT("Texture"); Format = TEXT("T3D"); break;
+	default: return false;
+	}
+
+	return true;
+}
+
+bool T3DLevelParser::PackageExportFor(const FString &Package, EExportType::Type Type, FExportEntry &Export)
+{
+	FString Class, Format;
+	if (!ExportFormatFor(Type, Class, Format))
+		return false;
+
+	Export.ExportFolder = ExportFolderFor(Type) / Package;
+	Export.Entry = FString::Printf(TEXT("%s|%s|%s|%s"), *Package, *Class, *Format, *Export.ExportFolder);
+	Export.Object.Reset();
+	Export.FileName.Reset();
+	return true;
+}
+
+bool T3DLevelParser::ObjectExportFor(const FRequirement &Requirement, EExportType::Type Type, FExportEntry &Export)
+{
+	FString Class, Format;
+	if (!ExportFormatFor(Type, Class, Format))
+		return false;
+
+	// Full path of the object, with its groups
+	int32 PathStart, PathEnd;
+	Requirement.OriginalUrl.FindChar(TCHAR('\''), PathStart);
+	Requirement.OriginalUrl.FindLastChar(TCHAR('\''), PathEnd);
+	FString ObjectPath = Requirement.OriginalUrl.Mid(PathStart + 1, PathEnd - PathStart - 1);
+	if (!ObjectPath.Contains(TEXT(".")))
+	{
+		ObjectPath = Requirement.Package + TEXT(".") + ObjectPath;
+	}
+
+	// Same file name as batchexport
+	Export.ExportFolder = ExportFolderFor(Type) / Requirement.Package;
+	Export.Object = Requirement.Name;
+	Export.FileName = Export.ExportFolder / Requirement.Name + TEXT(".") + Format;
+	Export.Entry = FString::Printf(TEXT("%s|%s|%s"), *Class, *ObjectPath, *Export.FileName);
+	return true;
+}
+
 bool T3DLevelParser::ExportPackage(const FString &Package, EExportType::Type Type, FString & ExportFolder)
 {
 	ExportFolder = ExportFolderFor(Type) / Package;
 
-	if (!IFileManager::Get().DirectoryExists(*ExportFolder))
+	if (!IsExported(ExportFolder))
+	{
+		// A package UDK failed to export is not exported again
+		FExportEntry Export;
+		if (FailedExports.Contains(ExportFolder) || !PackageExportFor(Package, Type, Export))
+			return false;
+
+		BulkExport(EExportMode::Package, { Export });
+		return IsExported(ExportFolder);
+	}
+
+	return true;
+}
+
+bool T3DLevelParser::ExportRequirement(const FRequirement &Requirement, EExportType::Type Type, FString & ExportFolder)
+{
+	if (CVarSelectiveExport.GetValueOnGameThread() == 0)
+		return ExportPackage(Requirement.Package, Type, ExportFolder);
+
+	ExportFolder = ExportFolderFor(Type) / Requirement.Package;
+
+	if (!IsExported(ExportFolder, Requirement.Name))
+	{
+		FExportEntry Export;
+		if (!ObjectExportFor(Requirement, Type, Export) || FailedExports.Contains(Export.FileName))
+			return false;
+
+		BulkExport(EExportMode::Object, { Export });
+		return IsExported(ExportFolder, Requirement.Name);
+	}
+
+	return true;
+}
+
+void T3DLevelParser::IndexPackageFiles()
+{
+	TArray<FString> FileNames;
+	const TCHAR * const Extensions[] = { TEXT("*.upk"), TEXT("*.udk") };
+	for (const TCHAR * Extension : Extensions)
+	{
+		IFileManager::Get().FindFilesRecursive(FileNames, *(UdkPath / TEXT("UDKGame/Content")), Extension, true, false, false);
+		IFileManager::Get().FindFilesRecursive(FileNames, *(UdkPath / TEXT("Engine/Content")), Extension, true, false, false);
+	}
+
+	for (const FString &FileName : FileNames)
+	{
+		PackageFiles.Add(FPaths::GetBaseFilename(FileName), FileName);
+	}
+	bPackageFilesIndexed = true;
+}
+
+FString T3DLevelParser::PackageFingerprint(const FString &Package)
+{
+	if (!bPackageFilesIndexed)
+	{
+		IndexPackageFiles();
+	}
+
+	// Packages don't change during an import, each one is read once
+	if (const FString * Fingerprint = PackageFingerprints.Find(Package))
+		return *Fingerprint;
+
+	const FString * FileName = PackageFiles.Find(Package);
+	if (FileName == NULL)
+		return UnknownPackageFingerprint;
+
+	const FFileStatData Stat = IFileManager::Get().GetStatData(**FileName);
+	return PackageFingerprints.Add(Package, FString::Printf(TEXT("%s|%lld|%lld"), **FileName, Stat.FileSize, Stat.ModificationTime.GetTicks()));
+}
+
+TSet<FString>& T3DLevelParser::GetExportedObjects(const FString &ExportFolder)
+{
+	if (TSet<FString> * Objects = ExportedObjects.Find(ExportFolder))
+		return *Objects;
+
+	// The fingerprint is followed by the exported objects, "*" for the whole package, a folder without one is unfinished
+	TSet<FString> &Objects = ExportedObjects.Add(ExportFolder);
+	const FString Fingerprint = PackageFingerprint(FPaths::GetCleanFilename(ExportFolder));
+	TArray<FString> Lines;
+	if (Fingerprint != UnknownPackageFingerprint
+		&& FFileHelper::LoadFileToStringArray(Lines, *(ExportFolder / ExportFingerprintName))
+		&& Lines.Num() >= 2
+		&& Lines[0] == Fingerprint)
+	{
+		Objects.Append(&Lines[1], Lines.Num() - 1);
+	}
+	return Objects;
+}
+
+bool T3DLevelParser::IsExported(const FString &ExportFolder, const FString &Object)
+{
+	const TSet<FString> &Objects = GetExportedObjects(ExportFolder);
+	return Objects.Contains(TEXT("*")) || (Object.Len() > 0 && Objects.Contains(Object));
+}
+
+void T3DLevelParser::SetExported(const FExportEntry &Export, bool bSuccess)
+{
+	// An object export that did not write its file failed
+	if (bSuccess && Export.FileName.Len() > 0)
+	{
+		bSuccess = IFileManager::Get().FileSize(*Export.FileName) > 0;
+	}
+
+	if (!bSuccess)
+	{
+		const FString &Key = Export.FileName.Len() > 0 ? Export.FileName : Export.ExportFolder;
+		UE_LOG(UDKImportPluginLog, Warning, TEXT("Unable to export : %s"), *Key);
+		FailedExports.Add(Key);
+		return;
+	}
+
+	const FString FingerprintFileName = Export.ExportFolder / ExportFingerprintName;
+	const FString Fingerprint = PackageFingerprint(FPaths::GetCleanFilename(Export.ExportFolder));
+
+	const FString Object = Export.Object.Len() > 0 ? Export.Object : TEXT("*");
+
+	// Objects exported from an older version of the package were forgotten when the folder was read, the file starts over
+	TSet<FString> &Objects = GetExportedObjects(Export.ExportFolder);
+	if (Objects.Num() == 0)
+	{
+		FFileHelper::SaveStringToFile(Fingerprint + LINE_TERMINATOR + Object + LINE_TERMINATOR, *FingerprintFileName, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+	}
+	else if (!Objects.Contains(Object))
 	{
-		FString Command;
-		switch (Type)
+		FFileHelper::SaveStringToFile(Object + LINE_TERMINATOR, *FingerprintFileName, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append);
+	}
+	Objects.Add(Object);
+}
+
+void T3DLevelParser::ExportPackagesFor(EExportType::Type Type, const TArray<TPair<FRequirement, FRequirementFixups>*> &Wave)
+{
+	// Only the required objects are exported, unless whole packages are asked for
+	const EExportMode::Type Mode = CVarSelectiveExport.GetValueOnGameThread() != 0 ? EExportMode::Object : EExportMode::Package;
+
+	// Exports are de-duplicated by package folder or by object file
+	TSet<FString> Queued;
+	TArray<FExportEntry> Exports;
+	for (const TPair<FRequirement, FRequirementFixups> * Pair : Wave)
+	{
+		FExportEntry Export;
+		if (Mode == EExportMode::Object ? !ObjectExportFor(Pair->Key, Type, Export) : !PackageExportFor(Pair->Key.Package, Type, Export))
 		{
-		case EExportType::Material: Command = TEXT("Material T3D"); break;
-		case EExportType::StaticMesh: Command = TEXT("StaticMesh FBX"); break;
-		case EExportType::MaterialInstanceConstant: Command = TEXT("MaterialInstanceConstant T3D"); break;
-		case EExportType::Texture2D: Command = TEXT("Texture TGA"); break;
-		case EExportType::Texture2DInfo: Command = TEXT("Texture T3D"); break;
-		default: return false;
+			UE_LOG(UDKImportPluginLog, Warning, TEXT("Unable to export : %s"), *Pair->Key.Url);
+			continue;
 		}
 
-		return RunUDK(FString::Printf(TEXT("batchexport %s %s %s"), *Package, *Command, *ExportFolder)) == 0;
+		const FString &Key = Mode == EExportMode::Object ? Export.FileName : Export.ExportFolder;
+		if (!Queued.Contains(Key) && !FailedExports.Contains(Key) && !IsExported(Export.ExportFolder, Export.Object))
+		{
+			Queued.Add(Key);
+			Exports.Add(MoveTemp(Export));
+		}
 	}
 
-	return true;
+	BulkExport(Mode, Exports);
+}
+
+FString T3DLevelParser::NewUDKOutputFile(const TCHAR * Prefix, FString &Name)
+{
+	// Commandlets write their files through FileWriter, which puts them in UDKGame/Logs
+	Name = FString::Printf(TEXT("%s_%d"), Prefix, UDKOutputCount++);
+	const FString FileName = UdkPath / TEXT("UDKGame/Logs") / Name + TEXT(".txt");
+	IFileManager::Get().Delete(*FileName);
+	return FileName;
+}
+
+void T3DLevelParser::BulkExport(EExportMode::Type Mode, const TArray<FExportEntry> &Exports)
+{
+	// The export server gets the whole wave at once and answers each export in order
+	if (UDKExportSession * Session = GetExportSession())
+	{
+		const TCHAR * Command = Mode == EExportMode::Object ? TEXT("exportobject ") : TEXT("export ");
+		for (const FExportEntry &Export : Exports)
+		{
+			Session->Send(Command + Export.Entry, UDKExportSession::FOnDone::CreateLambda([this, Export](int32 ReturnCode)
+			{
+				SetExported(Export, ReturnCode == 0);
+			}));
+		}
+		Session->Wait();
+		return;
+	}
+
+	// A wave is exported by a single UDK process, split when several processes may run at once or when the command line is full
+	const TCHAR * Commandlet = Mode == EExportMode::Object ? TEXT("ExportObjects") : TEXT("BulkExport");
+	const int32 NumProcesses = FMath::Min(UDKCommandletPool::GetMaxProcesses(), Exports.Num());
+	for (int32 Process = 0; Process < NumProcesses; ++Process)
+	{
+		FString ManifestName, ManifestFileName, CommandLine;
+		TArray<FExportEntry> ProcessExports;
+		for (int32 Index = Process; Index < Exports.Num(); Index += NumProcesses)
+		{
+			if (CommandLine.Len() > 0 && CommandLine.Len() + 1 + Exports[Index].Entry.Len() > MaxUDKCommandLine)
+			{
+				ExportPool.Add(ManifestName, CommandLine, UDKCommandletPool::FOnJobFinished::CreateRaw(this, &T3DLevelParser::ReadBulkExportManifest, ManifestFileName, ProcessExports));
+				CommandLine.Reset();
+				ProcessExports.Reset();
+			}
+
+			if (CommandLine.Len() == 0)
+			{
+				ManifestFileName = NewUDKOutputFile(TEXT("UDKImportBulkExport"), ManifestName);
+				CommandLine = FString::Printf(TEXT("run UDKPluginExport.%s Manifest=%s"), Commandlet, *ManifestName);
+			}
+
+			CommandLine += TEXT(" ") + Exports[Index].Entry;
+			ProcessExports.Add(Exports[Index]);
+		}
+
+		ExportPool.Add(ManifestName, CommandLine, UDKCommandletPool::FOnJobFinished::CreateRaw(this, &T3DLevelParser::ReadBulkExportManifest, ManifestFileName, ProcessExports));
+	}
+
+	ExportPool.Wait();
+}
+
+void T3DLevelParser::ReadBulkExportManifest(const UDKCommandletPool::FJob &Job, FString ManifestFileName, TArray<FExportEntry> Exports)
+{
+	// Records are Entry|ReturnCode, exports missing from the manifest did not run
+	TSet<FString> Exported;
+	TArray<FString> Records;
+	FFileHelper::LoadFileToStringArray(Records, *ManifestFileName);
+	for (const FString &Record : Records)
+	{
+		int32 ReturnCodeStart;
+		if (Record.FindLastChar(TCHAR('|'), ReturnCodeStart) && FCString::Atoi(*Record + ReturnCodeStart + 1) == 0)
+		{
+			Exported.Add(Record.Left(ReturnCodeStart));
+		}
+	}
+
+	for (const FExportEntry &Export : Exports)
+	{
+		SetExported(Export, Exported.Contains(Export.Entry));
+	}
 }
 
 void T3DLevelParser::ResolveRequirements(FScopedSlowTask& Task)
 {
 	FAssetToolsModule& AssetToolsModule = FModuleManager::Get().LoadModuleChecked<FAssetToolsModule>("AssetTools");
+
+	if (!bImportManifestLoaded)
+	{
+		LoadImportManifest();
+	}
+
+	// Only the files staged by this run are imported, not those left by the previous ones
+	IFileManager::Get().DeleteDirectory(*(TmpPath / TEXT("UDK")), false, true);
 	
 	Task.EnterProgressFrame(1.f, LOCTEXT("ExportStaticMeshRequirements", "Exporting StaticMesh referenced assets"));
-	ExportStaticMeshRequirements();
+	if (CVarDiscoverDependencies.GetValueOnGameThread() != 0)
+	{
+		ExportDependencies();
+	}
+	else
+	{
+		ExportStaticMeshRequirements();
+	}
 
 	Task.EnterProgressFrame(1.f, LOCTEXT("ExportMaterialInstanceConstantAssets", "Exporting MaterialInstanceConstant assets"));
 	ExportMaterialInstanceConstantAssets();
@@ -204,309 +531,725 @@ void T3DLevelParser::ResolveRequirements(FScopedSlowTask& Task)
 	Task.EnterProgressFrame(1.f, LOCTEXT("ImportAssets", "Importing Assets"));
 	TArray<FString> AssetsPath;
 	AssetsPath.Add(TmpPath / TEXT("UDK"));
-	AssetToolsModule.Get().ImportAssets(AssetsPath, TEXT("/Game/"));
+	for (UObject * Object : AssetToolsModule.Get().ImportAssets(AssetsPath, TEXT("/Game/")))
+	{
+		if (Object && Object->IsA<UStaticMesh>())
+			ChangedStaticMeshes.Add(Object);
+	}
 	
 	Task.EnterProgressFrame(1.f, LOCTEXT("ResolvingLinks", "Updating actors assets"));
-	for (auto Iter = Requirements.CreateIterator(); Iter; ++Iter)
 	{
-		const FRequirement &Requirement = Iter->Key;
+		TArray<TPair<FRequirement, FRequirementFixups>*> StaticMeshes, Textures;
+		GetRequirementsOfType(ERequirementType::StaticMesh, 0, StaticMeshes);
+		GetRequirementsOfType(ERequirementType::Texture, 0, Textures);
+
+		for (TPair<FRequirement, FRequirementFixups> * Pair : StaticMeshes)
+		{
+			if (Pair->Value.ResolvedObject)
+				continue;
+
+			const FRequirement &Requirement = Pair->Key;
+			FString ObjectPath = FString::Printf(TEXT("/Game/UDK/%s/Meshes/%s.%s"), *Requirement.Package, *Requirement.Name, *Requirement.Name);
+			UObject * Object = FindObject<UStaticMesh>(NULL, *ObjectPath);
+			if (Object)
+			{
+				FixRequirement(*Pair, Object);
+			}
+		}
+
+		for (TPair<FRequirement, FRequirementFixups> * Pair : Textures)
+		{
+			if (Pair->Value.ResolvedObject)
+				continue;
+
+			const FRequirement &Requirement = Pair->Key;
+			FString ObjectPath = FString::Printf(TEXT("/Game/UDK/%s/Textures/%s.%s"), *Requirement.Package, *Requirement.Name, *Requirement.Name);
+			UTexture2D * Texture2D = FindObject<UTexture2D>(NULL, *ObjectPath);
+			if (Texture2D)
+			{
+				FixRequirement(*Pair, Texture2D);
+			}
+		}
+	}
+
+	ApplyFixups();
+
+	// make sure that any static meshes, etc using this material will stop using the FMaterialResource of the original 
+	// material, and will use the new FMaterialResource created when we make a new UMaterial in place
+	FGlobalComponentReregisterContext RecreateComponents;
+
+	// Compile Materials
+	if (CVarBatchMaterialCompilation.GetValueOnGameThread() != 0)
+	{
+		CompileMaterials();
+	}
+	else
+	{
+		// Instances after their parents
+		for (UObject * Object : ParsedMaterials)
+		{
+			if (Object->IsA<UMaterial>())
+				Object->PostEditChange();
+		}
+
+		for (UObject * Object : ParsedMaterials)
+		{
+			if (Object->IsA<UMaterialInstanceConstant>())
+				Object->PostEditChange();
+		}
+	}
+	ParsedMaterials.Reset();
+	const int32 StaticMeshRebuilds = PostEditChangeFor(ERequirementType::StaticMesh, ChangedStaticMeshes);
+	UE_LOG(UDKImportPluginLog, Log, TEXT("StaticMesh rebuilds : %d"), StaticMeshRebuilds);
+	ChangedStaticMeshes.Reset();
+
+	SaveImportManifest();
+
+	PrintMissingRequirements();
+}
+
+void T3DLevelParser::AddStaticMeshMaterialFixup(const FString &MaterialUrl, const FString &StaticMeshUrl, int32 MaterialIdx)
+{
+	const int32 Material = RegisterRequirement(MaterialUrl);
+	const int32 StaticMesh = RegisterRequirement(StaticMeshUrl);
+	if (Material != INDEX_NONE && StaticMesh != INDEX_NONE)
+	{
+		StaticMeshMaterialFixups.Add({ Material, StaticMesh, MaterialIdx });
+	}
+}
+
+void T3DLevelParser::ApplyFixups()
+{
+	for (const FPolygonTextureFixup &Fixup : PolygonTextureFixups)
+	{
+		if (UObject * Material = Requirements[Fixup.Material].Value.ResolvedObject)
+			SetPolygonTexture(Material, Fixup.Polys, Fixup.PolyIndex);
+	}
+
+	for (const FTextureParameterFixup &Fixup : TextureParameterFixups)
+	{
+		if (UObject * Texture = Requirements[Fixup.Texture].Value.ResolvedObject)
+			SetTextureParameterValue(Texture, Fixup.MaterialInstanceConstant, Fixup.ParameterIndex);
+	}
+
+	// The slots of a mesh are set together, the mesh is rebuilt once by PostEditChangeFor
+	StaticMeshMaterialFixups.Sort([](const FStaticMeshMaterialFixup &A, const FStaticMeshMaterialFixup &B)
+	{
+		return A.StaticMesh < B.StaticMesh;
+	});
+
+	int32 ModifiedStaticMesh = INDEX_NONE;
+	for (const FStaticMeshMaterialFixup &Fixup : StaticMeshMaterialFixups)
+	{
+		UObject * Material = Requirements[Fixup.Material].Value.ResolvedObject;
+		UObject * StaticMesh = Requirements[Fixup.StaticMesh].Value.ResolvedObject;
+		if (Material && StaticMesh)
+		{
+			if (ModifiedStaticMesh != Fixup.StaticMesh)
+			{
+				StaticMesh->Modify();
+				ChangedStaticMeshes.Add(StaticMesh);
+				ModifiedStaticMesh = Fixup.StaticMesh;
+			}
+			SetStaticMeshMaterialResolved(StaticMesh, Material, Fixup.MaterialIdx);
+		}
+	}
+
+	for (const FStaticMeshFixup &Fixup : StaticMeshFixups)
+	{
+		if (UObject * StaticMesh = Requirements[Fixup.StaticMesh].Value.ResolvedObject)
+			SetStaticMesh(StaticMesh, Fixup.Component);
+	}
+
+	PolygonTextureFixups.Reset();
+	TextureParameterFixups.Reset();
+	StaticMeshMaterialFixups.Reset();
+	StaticMeshFixups.Reset();
+}
+
+void T3DLevelParser::CompileMaterials()
+{
+	// PostEditChange is replaced by the update context, its listeners are told once the shaders are compiled
+	TArray<UObject*> Compiled;
+	int32 NumMaterials = 0, NumMaterialInstances = 0;
+	{
+		// The users of all the materials are updated once, when the context is destroyed
+		FMaterialUpdateContext UpdateContext;
+
+		// Materials loaded from the manifest were compiled when they were imported
+		for (UObject * Object : ParsedMaterials)
+		{
+			if (UMaterial * Material = Cast<UMaterial>(Object))
+			{
+				Material->ForceRecompileForRendering();
+				Material->MarkPackageDirty();
+				UpdateContext.AddMaterial(Material);
+				Compiled.Add(Material);
+				++NumMaterials;
+			}
+		}
+
+		// Instances are compiled after their parents were submitted
+		for (UObject * Object : ParsedMaterials)
+		{
+			if (UMaterialInstanceConstant * MaterialInstanceConstant = Cast<UMaterialInstanceConstant>(Object))
+			{
+				MaterialInstanceConstant->InitStaticPermutation();
+				MaterialInstanceConstant->MarkPackageDirty();
+				UpdateContext.AddMaterialInstance(MaterialInstanceConstant);
+				Compiled.Add(MaterialInstanceConstant);
+				++NumMaterialInstances;
+			}
+		}
+	}
+
+	// Shader jobs of every material were submitted together, they are waited for once
+	if (GShaderCompilingManager)
+	{
+		GShaderCompilingManager->FinishAllCompilation();
+	}
+
+	for (UObject * Object : Compiled)
+	{
+		FPropertyChangedEvent PropertyChangedEvent(NULL);
+		FCoreUObjectDelegates::OnObjectPropertyChanged.Broadcast(Object, PropertyChangedEvent);
+	}
+
+	UE_LOG(UDKImportPluginLog, Log, TEXT("Compiled %d Materials and %d MaterialInstanceConstants"), NumMaterials, NumMaterialInstances);
+}
+
+int32 T3DLevelParser::PostEditChangeFor(ERequirementType::Type Kind, TSet<UObject*> &Changed)
+{
+	// Objects the import left untouched are not rebuilt, the changed ones once each
+	int32 Count = 0;
+	for (int32 Index : RequirementBuckets[Kind])
+	{
+		UObject * ResolvedObject = Requirements[Index].Value.ResolvedObject;
+		if (ResolvedObject && Changed.Remove(ResolvedObject) > 0)
+		{
+			ResolvedObject->PostEditChange();
+			++Count;
+		}
+	}
+	return Count;
+}
+
+void T3DLevelParser::ExportStaticMeshRequirements()
+{
+	TArray<TPair<FRequirement, FRequirementFixups>*> StaticMeshRequirements;
+	GetRequirementsOfType(ERequirementType::StaticMesh, 0, StaticMeshRequirements);
+
+	if (UDKExportSession * Session = GetExportSession())
+	{
+		for (const TPair<FRequirement, FRequirementFixups> * Pair : StaticMeshRequirements)
+		{
+			Session->Send(TEXT("meshmaterials ") + Pair->Key.OriginalUrl, UDKExportSession::FOnDone(),
+				UDKExportSession::FOnData::CreateRaw(this, &T3DLevelParser::AddStaticMeshMaterial, Pair->Key.OriginalUrl));
+		}
+		Session->Wait();
+		return;
+	}
+
+	TArray<FString> StaticMeshes;
+	for (const TPair<FRequirement, FRequirementFixups> * Pair : StaticMeshRequirements)
+	{
+		StaticMeshes.Add(Pair->Key.OriginalUrl);
+	}
+
+	if (StaticMeshes.Num() == 0)
+		return;
+
+	if (CVarMeshListFile.GetValueOnGameThread() != 0)
+	{
+		// One list per process, all of them are written before any process reads the ini
+		const int32 NumProcesses = FMath::Min(UDKCommandletPool::GetMaxProcesses(), StaticMeshes.Num());
+		TArray<FString> OutputNames, OutputFileNames;
+		FString Config;
+		for (int32 Process = 0; Process < NumProcesses; ++Process)
+		{
+			FString &OutputName = OutputNames.AddDefaulted_GetRef();
+			OutputFileNames.Add(NewUDKOutputFile(TEXT("UDKImportMeshMaterials"), OutputName));
+
+			Config += FString::Printf(TEXT("[%s ExportStaticMeshMaterialsList]\r\n"), *OutputName);
+			for (int32 Index = Process; Index < StaticMeshes.Num(); Index += NumProcesses)
+			{
+				Config += FString::Printf(TEXT("StaticMeshes=%s\r\n"), *StaticMeshes[Index]);
+			}
+			Config += TEXT("\r\n");
+		}
+
+		if (FFileHelper::SaveStringToFile(Config, *(UdkPath / TEXT("UDKGame/Config/UDKPluginExport.ini"))))
+		{
+			for (int32 Process = 0; Process < NumProcesses; ++Process)
+			{
+				const FString CommandLine = FString::Printf(TEXT("run UDKPluginExport.ExportStaticMeshMaterials Output=%s List=%s"), *OutputNames[Process], *OutputNames[Process]);
+				ExportPool.Add(OutputNames[Process], CommandLine, UDKCommandletPool::FOnJobFinished::CreateRaw(this, &T3DLevelParser::ReadStaticMeshMaterials, OutputFileNames[Process]));
+			}
+			ExportPool.Wait();
+			return;
+		}
+
+		UE_LOG(UDKImportPluginLog, Warning, TEXT("Unable to write the StaticMesh lists, they are given on the command line"));
+	}
+
+	// Batches are as large as the UDK command line allows
+	FString OutputName, OutputFileName, CommandLine;
+	for (const FString &StaticMesh : StaticMeshes)
+	{
+		if (CommandLine.Len() > 0 && CommandLine.Len() + 1 + StaticMesh.Len() > MaxUDKCommandLine)
+		{
+			ExportPool.Add(OutputName, CommandLine, UDKCommandletPool::FOnJobFinished::CreateRaw(this, &T3DLevelParser::ReadStaticMeshMaterials, OutputFileName));
+			CommandLine.Reset();
+		}
+
+		if (CommandLine.Len() == 0)
+		{
+			OutputFileName = NewUDKOutputFile(TEXT("UDKImportMeshMaterials"), OutputName);
+			CommandLine = FString::Printf(TEXT("run UDKPluginExport.ExportStaticMeshMaterials Output=%s"), *OutputName);
+		}
+
+		CommandLine += TEXT(" ") + StaticMesh;
+	}
+	ExportPool.Add(OutputName, CommandLine, UDKCommandletPool::FOnJobFinished::CreateRaw(this, &T3DLevelParser::ReadStaticMeshMaterials, OutputFileName));
+
+	// Batches run concurrently
+	ExportPool.Wait();
+}
+
+void T3DLevelParser::ReadStaticMeshMaterials(const UDKCommandletPool::FJob &Job, FString OutputFileName)
+{
+	// Records are StaticMeshUrl<tab>Slot<tab>MaterialUrl
+	TArray<FString> Records;
+	FFileHelper::LoadFileToStringArray(Records, *OutputFileName);
+	for (const FString &Record : Records)
+	{
+		TArray<FString> Fields;
+		if (Record.ParseIntoArray(Fields, TEXT("\t"), false) == 3)
+		{
+			AddStaticMeshMaterialFixup(Fields[2], Fields[0], FCString::Atoi(*Fields[1]));
+		}
+	}
+}
+
+void T3DLevelParser::AddStaticMeshMaterial(const FString &Record, FString StaticMeshUrl)
+{
+	// Slot<tab>MaterialUrl
+	const TCHAR * MaterialIdxEnd = FCString::Strchr(*Record, TCHAR('\t'));
+	if (MaterialIdxEnd != NULL)
+	{
+		int32 MaterialIdx = FCString::Atoi(*Record);
+		FString MaterialUrl(MaterialIdxEnd + 1);
+		AddStaticMeshMaterialFixup(MaterialUrl, StaticMeshUrl, MaterialIdx);
+	}
+}
+
+void T3DLevelParser::ExportDependencies()
+{
+	// Every reference UDK can follow starts from these, so all exports are known before the first one
+	TArray<TPair<FRequirement, FRequirementFixups>*> RootRequirements;
+	GetRequirementsOfType(ERequirementType::StaticMesh, 0, RootRequirements);
+	GetRequirementsOfType(ERequirementType::Material, 0, RootRequirements);
+	GetRequirementsOfType(ERequirementType::MaterialInstanceConstant, 0, RootRequirements);
+
+	TArray<FString> Roots;
+	for (const TPair<FRequirement, FRequirementFixups> * Pair : RootRequirements)
+	{
+		Roots.Add(Pair->Key.OriginalUrl);
+	}
+
+	if (Roots.Num() == 0)
+		return;
+
+	// The server remembers the objects it walked, references shared by several roots are answered once
+	if (UDKExportSession * Session = GetExportSession())
+	{
+		for (const FString &Root : Roots)
+		{
+			Session->Send(TEXT("dependencies ") + Root, UDKExportSession::FOnDone(),
+				UDKExportSession::FOnData::CreateRaw(this, &T3DLevelParser::AddDependency));
+		}
+		Session->Wait();
+		return;
+	}
+
+	// A single process walks the whole graph, its roots can't fit on the command line
+	FString OutputName;
+	const FString OutputFileName = NewUDKOutputFile(TEXT("UDKImportDependencies"), OutputName);
+	FString Config = FString::Printf(TEXT("[%s ExportDependenciesList]\r\n"), *OutputName);
+	for (const FString &Root : Roots)
+	{
+		Config += FString::Printf(TEXT("Roots=%s\r\n"), *Root);
+	}
+
+	// Not in UDKPluginExport.ini, which the StaticMesh material lists overwrite
+	if (!FFileHelper::SaveStringToFile(Config, *(UdkPath / TEXT("UDKGame/Config/UDKPluginDependencies.ini"))))
+	{
+		UE_LOG(UDKImportPluginLog, Warning, TEXT("Unable to write the dependency roots, only StaticMesh materials are queried"));
+		ExportStaticMeshRequirements();
+		return;
+	}
+
+	const FString CommandLine = FString::Printf(TEXT("run UDKPluginExport.ExportDependencies Output=%s List=%s"), *OutputName, *OutputName);
+	ExportPool.Add(OutputName, CommandLine, UDKCommandletPool::FOnJobFinished::CreateRaw(this, &T3DLevelParser::ReadDependencies, OutputFileName));
+	ExportPool.Wait();
+}
+
+void T3DLevelParser::ReadDependencies(const UDKCommandletPool::FJob &Job, FString OutputFileName)
+{
+	TArray<FString> Records;
+	FFileHelper::LoadFileToStringArray(Records, *OutputFileName);
+	for (const FString &Record : Records)
+	{
+		AddDependency(Record);
+	}
+}
+
+void T3DLevelParser::AddDependency(const FString &Record)
+{
+	// FromUrl<tab>Kind<tab>ToUrl, Kind is a material slot for StaticMeshes
+	TArray<FString> Fields;
+	if (Record.ParseIntoArray(Fields, TEXT("\t"), false) != 3 || Fields[1].Len() == 0)
+		return;
+
+	if (FChar::IsDigit(Fields[1][0]))
+	{
+		AddStaticMeshMaterialFixup(Fields[2], Fields[0], FCString::Atoi(*Fields[1]));
+	}
+	else
+	{
+		// Parents and textures get their actions when their MaterialInstanceConstant or Material is parsed
+		AddRequirement(Fields[2], UObjectDelegate());
 
-		if (Requirement.Type == TEXT("StaticMesh"))
+		FRequirement From, To;
+		if (Fields[1] == TEXT("Parent") && ParseResourceUrl(Fields[0], From) && ParseResourceUrl(Fields[2], To))
 		{
-			FString ObjectPath = FString::Printf(TEXT("/Game/UDK/%s/Meshes/%s.%s"), *Requirement.Package, *Requirement.Name, *Requirement.Name);
-			UObject * Object = FindObject<UStaticMesh>(NULL, *ObjectPath);
-			if (Object)
-			{
-				FixRequirement(*Iter, Object);
-			}
-		}
-		else if (Requirement.Type.StartsWith(TEXT("Texture")))
-		{
-			FString ObjectPath = FString::Printf(TEXT("/Game/UDK/%s/Textures/%s.%s"), *Requirement.Package, *Requirement.Name, *Requirement.Name);
-			UTexture2D * Texture2D = FindObject<UTexture2D>(NULL, *ObjectPath);
-			if (Texture2D)
-			{
-				FixRequirement(*Iter, Texture2D);
-			}
+			MaterialParents.Add(From.Url, To.Url);
 		}
 	}
-
-	// make sure that any static meshes, etc using this material will stop using the FMaterialResource of the original 
-	// material, and will use the new FMaterialResource created when we make a new UMaterial in place
-	FGlobalComponentReregisterContext RecreateComponents;
-
-	// Compile Materials
-	PostEditChangeFor(TEXT("Material"));
-	PostEditChangeFor(TEXT("MaterialInstanceConstant"));
-	PostEditChangeFor(TEXT("StaticMesh"));
-
-	PrintMissingRequirements();
 }
 
-void T3DLevelParser::PostEditChangeFor(const FString &Type)
+void T3DLevelParser::LoadImportManifest()
 {
-	for (auto Iter = Requirements.CreateIterator(); Iter; ++Iter)
+	// Records are Url<tab>ObjectPath<tab>Fingerprint
+	TArray<FString> Records;
+	FFileHelper::LoadFileToStringArray(Records, *(TmpPath / ImportManifestName));
+	for (const FString &Record : Records)
 	{
-		const FRequirement &Requirement = Iter->Key;
-		if (Requirement.Type == Type)
+		TArray<FString> Fields;
+		if (Record.ParseIntoArray(Fields, TEXT("\t"), false) == 3)
 		{
-			auto& Fixups = Iter->Value;
-			if (Fixups.ResolvedObject)
-				Fixups.ResolvedObject->PostEditChange();
+			ImportManifest.Add(Fields[0], { Fields[1], Fields[2] });
 		}
 	}
+	bImportManifestLoaded = true;
 }
 
-void T3DLevelParser::ExportStaticMeshRequirements()
+void T3DLevelParser::SaveImportManifest()
 {
-	int32 StaticMeshesParamsCount = 0;
-	FString StaticMeshesParams = TEXT("run UDKPluginExport.ExportStaticMeshMaterials");
-	for (auto Iter = Requirements.CreateConstIterator(); Iter; ++Iter)
+	const ERequirementType::Type Kinds[] = { ERequirementType::StaticMesh, ERequirementType::Material, ERequirementType::MaterialInstanceConstant, ERequirementType::Texture };
+	for (ERequirementType::Type Kind : Kinds)
 	{
-		const FRequirement &Requirement = Iter->Key;
-
-		if (Requirement.Type == TEXT("StaticMesh"))
+		for (int32 Index : RequirementBuckets[Kind])
 		{
-			StaticMeshesParams += TEXT(" ") + Requirement.OriginalUrl;
-			++StaticMeshesParamsCount;
-			if (StaticMeshesParamsCount >= 200)
+			const TPair<FRequirement, FRequirementFixups> &Pair = Requirements[Index];
+			const FString Fingerprint = PackageFingerprint(Pair.Key.Package);
+			if (Pair.Value.ResolvedObject && Fingerprint != UnknownPackageFingerprint)
 			{
-				ExportStaticMeshRequirements(StaticMeshesParams);
-				StaticMeshesParamsCount = 0;
-				StaticMeshesParams = TEXT("run UDKPluginExport.ExportStaticMeshMaterials");
+				ImportManifest.Add(Pair.Key.Url, { Pair.Value.ResolvedObject->GetPathName(), Fingerprint });
 			}
 		}
 	}
 
-	if (StaticMeshesParamsCount > 0)
+	FString Manifest;
+	for (const TPair<FString, FImportedAsset> &Asset : ImportManifest)
+	{
+		Manifest += FString::Printf(TEXT("%s\t%s\t%s\r\n"), *Asset.Key, *Asset.Value.ObjectPath, *Asset.Value.Fingerprint);
+	}
+
+	if (!FFileHelper::SaveStringToFile(Manifest, *(TmpPath / ImportManifestName)))
 	{
-		ExportStaticMeshRequirements(StaticMeshesParams);
+		UE_LOG(UDKImportPluginLog, Warning, TEXT("Unable to write the import manifest : %s"), *(TmpPath / ImportManifestName));
 	}
 }
 
-void T3DLevelParser::ExportStaticMeshRequirements(const FString &StaticMeshesParams)
+void T3DLevelParser::ResolveImported(const TArray<TPair<FRequirement, FRequirementFixups>*> &Wave, TArray<TPair<FRequirement, FRequirementFixups>*> &OutUnresolved)
 {
-	FString ExportStaticMeshMaterialsOutput;
-	if (RunUDK(StaticMeshesParams, ExportStaticMeshMaterialsOutput) == 0)
+	for (TPair<FRequirement, FRequirementFixups> * Pair : Wave)
 	{
-		ResetParser(ExportStaticMeshMaterialsOutput);
-		while (NextLine())
+		if (Pair->Value.ResolvedObject)
+			continue;
+
+		// Assets imported from an unchanged package are loaded from their recorded path, without export nor probe
+		const FImportedAsset * Asset = ImportManifest.Find(Pair->Key.Url);
+		if (Asset)
 		{
-			if (Line.StartsWith(TEXT("ScriptLog: ")))
+			const FString Fingerprint = PackageFingerprint(Pair->Key.Package);
+			if (Fingerprint != UnknownPackageFingerprint && Asset->Fingerprint == Fingerprint)
 			{
-				int32 StaticMeshUrlEndIndex = Line.Find(TEXT(" "), ESearchCase::CaseSensitive, ESearchDir::FromStart, 11);
-				int32 MaterialIdxEndIndex = Line.Find(TEXT(" "), ESearchCase::CaseSensitive, ESearchDir::FromStart, StaticMeshUrlEndIndex + 1);
-				if (StaticMeshUrlEndIndex != -1 && MaterialIdxEndIndex != -1)
+				if (UObject * Object = LoadObject<UObject>(NULL, *Asset->ObjectPath, NULL, LOAD_NoWarn | LOAD_Quiet))
 				{
-					FString StaticMeshUrl = Line.Mid(11, StaticMeshUrlEndIndex - 11);
-					int32 MaterialIdx = FCString::Atoi(*Line.Mid(StaticMeshUrlEndIndex + 1, MaterialIdxEndIndex - StaticMeshUrlEndIndex - 1));
-					FString MaterialUrl = Line.Mid(MaterialIdxEndIndex + 1);
-					AddRequirement(MaterialUrl, UObjectDelegate::CreateRaw(this, &T3DLevelParser::SetStaticMeshMaterial, StaticMeshUrl, MaterialIdx));
+					FixRequirement(*Pair, Object);
+					continue;
 				}
 			}
+			else
+			{
+				// The package changed since, its asset must be imported again
+				StaleImports.Add(Pair->Key.Url);
+			}
+
+			ImportManifest.Remove(Pair->Key.Url);
 		}
+
+		OutUnresolved.Add(Pair);
 	}
 }
 
-void T3DLevelParser::ExportMaterialInstanceConstantAssets()
+UObject * T3DLevelParser::FindPreviousImport(const FRequirement &Requirement, const FString &ObjectPath, bool &bOutStale)
 {
-	bool bRequiresAnotherLoop;
+	UObject * Object = LoadObject<UObject>(NULL, *ObjectPath, NULL, LOAD_NoWarn | LOAD_Quiet);
+	bOutStale = Object && StaleImports.Contains(Requirement.Url);
+	return Object;
+}
 
-	do
+void T3DLevelParser::SortByParents(const TArray<TPair<FRequirement, FRequirementFixups>*> &Instances, TArray<TPair<FRequirement, FRequirementFixups>*> &OutWave)
+{
+	TMap<FString, TPair<FRequirement, FRequirementFixups>*> Unresolved;
+	for (TPair<FRequirement, FRequirementFixups> * Pair : Instances)
 	{
-		bRequiresAnotherLoop = false;
+		if (!Pair->Value.ResolvedObject)
+		{
+			Unresolved.Add(Pair->Key.Url, Pair);
+		}
+	}
 
-		FScopedSlowTask Task(Requirements.Num(), LOCTEXT("ExportMaterialInstanceConstantAssetsInner", "Exporting Material Instance Constant Asset..."));
-		Task.MakeDialog();
+	// Parents come before their children, so a child gets its parent as soon as it is parsed
+	TSet<FString> Visited;
+	TArray<TPair<FRequirement, FRequirementFixups>*> Chain;
+	for (TPair<FRequirement, FRequirementFixups> * Pair : Instances)
+	{
+		Chain.Reset();
+		for (TPair<FRequirement, FRequirementFixups> * Instance = Unresolved.FindRef(Pair->Key.Url); Instance && !Visited.Contains(Instance->Key.Url);)
+		{
+			Visited.Add(Instance->Key.Url);
+			Chain.Add(Instance);
+
+			const FString * Parent = MaterialParents.Find(Instance->Key.Url);
+			Instance = Parent ? Unresolved.FindRef(*Parent) : NULL;
+		}
 
-		for (auto Iter = Requirements.CreateIterator(); Iter; ++Iter)
+		for (int32 Index = Chain.Num() - 1; Index >= 0; --Index)
 		{
-			const FRequirement& Requirement = Iter->Key;
+			OutWave.Add(Chain[Index]);
+		}
+	}
+}
+
+void T3DLevelParser::ExportMaterialInstanceConstantAssets()
+{
+	// Each wave holds the instances found by the previous one, a single wave once the dependencies were walked
+	int32 Next = 0;
+	for (;;)
+	{
+		TArray<TPair<FRequirement, FRequirementFixups>*> Instances, Unresolved, Wave;
+		Next = GetRequirementsOfType(ERequirementType::MaterialInstanceConstant, Next, Instances);
+		if (Instances.Num() == 0)
+			break;
 
-			// N.B: Adjust total amount of work in-case the number of requirements change.
-			Task.TotalAmountOfWork = Requirements.Num();
+		ResolveImported(Instances, Unresolved);
+		SortByParents(Unresolved, Wave);
+		ExportPackagesFor(EExportType::MaterialInstanceConstant, Wave);
 
-			if (Requirement.Type == TEXT("MaterialInstanceConstant") && !Iter->Value.ResolvedObject)
-			{
-				FString ExportFolder;
-				FString FileName = Requirement.Name + TEXT(".T3D");
+		FScopedSlowTask Task(Wave.Num(), LOCTEXT("ExportMaterialInstanceConstantAssetsInner", "Exporting Material Instance Constant Asset..."));
+		Task.MakeDialog();
+
+		for (TPair<FRequirement, FRequirementFixups> * Pair : Wave)
+		{
+			const FRequirement& Requirement = Pair->Key;
+			FString ExportFolder;
+			FString FileName = Requirement.Name + TEXT(".T3D");
 
-				Task.EnterProgressFrame(1.f, FText::FromString(Requirement.Url));
+			Task.EnterProgressFrame(1.f, FText::FromString(Requirement.Url));
 
-				ExportPackage(Requirement.Package, EExportType::MaterialInstanceConstant, ExportFolder);
+			ExportRequirement(Requirement, EExportType::MaterialInstanceConstant, ExportFolder);
 
-				FString ObjectPath = FString::Printf(TEXT("/Game/UDK/%s/MaterialInstances/%s.%s"), *Requirement.Package, *Requirement.Name, *Requirement.Name);
-				UMaterialInstanceConstant* MaterialInstanceConstant = LoadObject<UMaterialInstanceConstant>(NULL, *ObjectPath, NULL, LOAD_NoWarn | LOAD_Quiet);
-				if (!MaterialInstanceConstant)
+			// Only requirements missing from the manifest are probed, their asset may come from an older import unless its package changed
+			FString ObjectPath = FString::Printf(TEXT("/Game/UDK/%s/MaterialInstances/%s.%s"), *Requirement.Package, *Requirement.Name, *Requirement.Name);
+			// The asset of a changed package is parsed again in place, the assets referencing it keep it
+			bool bStale;
+			UMaterialInstanceConstant* MaterialInstanceConstant = Cast<UMaterialInstanceConstant>(FindPreviousImport(Requirement, ObjectPath, bStale));
+			if (!MaterialInstanceConstant || bStale)
+			{
+				T3DMaterialInstanceConstantParser MaterialInstanceConstantParser(this, Requirement.Package);
+				if (UMaterialInstanceConstant * Imported = MaterialInstanceConstantParser.ImportT3DFile(ExportFolder / FileName, MaterialInstanceConstant))
 				{
-					T3DMaterialInstanceConstantParser MaterialInstanceConstantParser(this, Requirement.Package);
-					MaterialInstanceConstant = MaterialInstanceConstantParser.ImportT3DFile(ExportFolder / FileName);
+					MaterialInstanceConstant = Imported;
+					ParsedMaterials.Add(Imported);
 				}
+				else if (MaterialInstanceConstant)
+					UE_LOG(UDKImportPluginLog, Warning, TEXT("Unable to import again, the previous import is kept : %s"), *Requirement.Url);
+			}
 
-				if (MaterialInstanceConstant)
-				{
-					bRequiresAnotherLoop = true;
-					FixRequirement(*Iter, MaterialInstanceConstant);
-				}
-				else
-				{
-					UE_LOG(UDKImportPluginLog, Warning, TEXT("Unable to import : %s"), *Requirement.Url);
-				}
+			if (MaterialInstanceConstant)
+			{
+				FixRequirement(*Pair, MaterialInstanceConstant);
 			}
 			else
 			{
-				Task.EnterProgressFrame();
+				UE_LOG(UDKImportPluginLog, Warning, TEXT("Unable to import : %s"), *Requirement.Url);
 			}
 		}
-	} while (bRequiresAnotherLoop);
+	}
 }
 
 void T3DLevelParser::ExportMaterialAssets()
 {
-	FScopedSlowTask Task(Requirements.Num(), LOCTEXT("ExportMaterialAssetsInner", "Exporting Material Asset..."));
+	TArray<TPair<FRequirement, FRequirementFixups>*> Materials, Wave;
+	GetRequirementsOfType(ERequirementType::Material, 0, Materials);
+	ResolveImported(Materials, Wave);
+	ExportPackagesFor(EExportType::Material, Wave);
+
+	FScopedSlowTask Task(Wave.Num(), LOCTEXT("ExportMaterialAssetsInner", "Exporting Material Asset..."));
 	Task.MakeDialog();
 
-	for (auto Iter = Requirements.CreateIterator(); Iter; ++Iter)
+	for (TPair<FRequirement, FRequirementFixups> * Pair : Wave)
 	{
-		const FRequirement &Requirement = Iter->Key;
+		const FRequirement &Requirement = Pair->Key;
+		FString ExportFolder;
+		FString FileName = Requirement.Name + TEXT(".T3D");
 
-		// N.B: Adjust total amount of work in-case the number of requirements change.
-		Task.TotalAmountOfWork = Requirements.Num();
-
-		if (Requirement.Type == TEXT("Material"))
-		{
-			FString ExportFolder;
-			FString FileName = Requirement.Name + TEXT(".T3D");
+		Task.EnterProgressFrame(1.f, FText::FromString(Requirement.Url));
 
-			Task.EnterProgressFrame(1.f, FText::FromString(Requirement.Url));
+		ExportRequirement(Requirement, EExportType::Material, ExportFolder);
 
-			ExportPackage(Requirement.Package, EExportType::Material, ExportFolder);
-				
-			FString ObjectPath = FString::Printf(TEXT("/Game/UDK/%s/Materials/%s.%s"), *Requirement.Package, *Requirement.Name, *Requirement.Name);
-			UMaterial * Material = LoadObject<UMaterial>(NULL, *ObjectPath, NULL, LOAD_NoWarn | LOAD_Quiet);
-			if (!Material)
+		// Only requirements missing from the manifest are probed, their asset may come from an older import unless its package changed
+		FString ObjectPath = FString::Printf(TEXT("/Game/UDK/%s/Materials/%s.%s"), *Requirement.Package, *Requirement.Name, *Requirement.Name);
+		// The asset of a changed package is parsed again in place, the assets referencing it keep it
+		bool bStale;
+		UMaterial * Material = Cast<UMaterial>(FindPreviousImport(Requirement, ObjectPath, bStale));
+		if (!Material || bStale)
+		{
+			T3DMaterialParser MaterialParser(this, Requirement.Package);
+			if (UMaterial * Imported = MaterialParser.ImportMaterialT3DFile(ExportFolder / FileName, Material))
 			{
-				T3DMaterialParser MaterialParser(this, Requirement.Package);
-				Material = MaterialParser.ImportMaterialT3DFile(ExportFolder / FileName);
+				Material = Imported;
+				ParsedMaterials.Add(Imported);
 			}
+			else if (Material)
+				UE_LOG(UDKImportPluginLog, Warning, TEXT("Unable to import again, the previous import is kept : %s"), *Requirement.Url);
+		}
 
-			if (Material)
-			{
-				FixRequirement(*Iter, Material);
-			}
-			else
-			{
-				UE_LOG(UDKImportPluginLog, Warning, TEXT("Unable to import : %s"), *Requirement.Url);
-			}
+		if (Material)
+		{
+			FixRequirement(*Pair, Material);
 		}
 		else
 		{
-			Task.EnterProgressFrame();
+			UE_LOG(UDKImportPluginLog, Warning, TEXT("Unable to import : %s"), *Requirement.Url);
 		}
 	}
 }
 
 void T3DLevelParser::ExportTextureAssets()
 {
+	TArray<TPair<FRequirement, FRequirementFixups>*> Textures, Wave;
+	GetRequirementsOfType(ERequirementType::Texture, 0, Textures);
+	ResolveImported(Textures, Wave);
+	ExportPackagesFor(EExportType::Texture2D, Wave);
+
 	IFileManager& FileManager = IFileManager::Get();
-	FScopedSlowTask Task(Requirements.Num(), LOCTEXT("ExportTextureAssetsInner", "Exporting Texture Asset..."));
+
+	FScopedSlowTask Task(Wave.Num(), LOCTEXT("ExportTextureAssetsInner", "Exporting Texture Asset..."));
 	Task.MakeDialog();
 
-	for (auto Iter = Requirements.CreateConstIterator(); Iter; ++Iter)
+	for (const TPair<FRequirement, FRequirementFixups> * Pair : Wave)
 	{
-		const FRequirement &Requirement = Iter->Key;
-
-		// N.B: Adjust total amount of work in-case the number of requirements change.
-		Task.TotalAmountOfWork = Requirements.Num();
-
-		if (Requirement.Type.StartsWith(TEXT("Texture")))
-		{
-			FString ExportFolder;
-			FString ImportFolder = TmpPath / TEXT("UDK") / Requirement.Package / TEXT("Textures");
-			FString FileName = Requirement.Name + TEXT(".TGA");
+		const FRequirement &Requirement = Pair->Key;
+		FString ExportFolder;
+		FString ImportFolder = TmpPath / TEXT("UDK") / Requirement.Package / TEXT("Textures");
+		FString FileName = Requirement.Name + TEXT(".TGA");
 
-			Task.EnterProgressFrame(1.f, FText::FromString(Requirement.Url));
+		Task.EnterProgressFrame(1.f, FText::FromString(Requirement.Url));
 
-			ExportPackage(Requirement.Package, EExportType::Texture2D, ExportFolder);
+		ExportRequirement(Requirement, EExportType::Texture2D, ExportFolder);
 
-			FileManager.MakeDirectory(*ImportFolder, true);
-			if (FileManager.FileSize(*(ExportFolder / FileName)) > 0)
-			{
-				FileManager.Copy(*(ImportFolder / FileName), *(ExportFolder / FileName));
-			}
-		}
-		else
+		FileManager.MakeDirectory(*ImportFolder, true);
+		if (FileManager.FileSize(*(ExportFolder / FileName)) > 0)
 		{
-			Task.EnterProgressFrame();
+			FileManager.Copy(*(ImportFolder / FileName), *(ExportFolder / FileName));
 		}
 	}
 }
 
 void T3DLevelParser::ExportStaticMeshAssets()
 {
+	TArray<TPair<FRequirement, FRequirementFixups>*> StaticMeshes, Wave;
+	GetRequirementsOfType(ERequirementType::StaticMesh, 0, StaticMeshes);
+	ResolveImported(StaticMeshes, Wave);
+	ExportPackagesFor(EExportType::StaticMesh, Wave);
+
 	IFileManager & FileManager = IFileManager::Get();
-	FScopedSlowTask Task(Requirements.Num(), LOCTEXT("ExportStaticMeshAssetsInner", "Exporting Static Mesh Asset..."));
+
+	FScopedSlowTask Task(Wave.Num(), LOCTEXT("ExportStaticMeshAssetsInner", "Exporting Static Mesh Asset..."));
 	Task.MakeDialog();
 
 	FileManager.MakeDirectory(*(TmpPath / TEXT("ExportedMeshes")), true);
 
-	for (auto Iter = Requirements.CreateConstIterator(); Iter; ++Iter)
+	for (const TPair<FRequirement, FRequirementFixups> * Pair : Wave)
 	{
-		const FRequirement &Requirement = Iter->Key;
-
-		// N.B: Adjust total amount of work in-case the number of requirements change.
-		Task.TotalAmountOfWork = Requirements.Num();
+		const FRequirement &Requirement = Pair->Key;
+		FString ExportFolder;
+		FString ImportFolder = TmpPath / TEXT("UDK") / Requirement.Package / TEXT("Meshes");
+		FString FileNameOBJ = Requirement.Name + TEXT(".OBJ");
+		FString FileNameFBX = Requirement.Name + TEXT(".FBX");
 
-		if (Requirement.Type == TEXT("StaticMesh"))
-		{
-			FString ExportFolder;
-			FString ImportFolder = TmpPath / TEXT("UDK") / Requirement.Package / TEXT("Meshes");
-			FString FileNameOBJ = Requirement.Name + TEXT(".OBJ");
-			FString FileNameFBX = Requirement.Name + TEXT(".FBX");
-
-			Task.EnterProgressFrame(1.f, FText::FromString(Requirement.Url));
+		Task.EnterProgressFrame(1.f, FText::FromString(Requirement.Url));
 
-			ExportPackage(Requirement.Package, EExportType::StaticMesh, ExportFolder);
+		ExportRequirement(Requirement, EExportType::StaticMesh, ExportFolder);
 
-			FileManager.MakeDirectory(*ImportFolder, true);
-			if (FileManager.FileSize(*(ExportFolder / FileNameFBX)) > 0)
-			{
-				FileManager.Copy(*(ImportFolder / FileNameFBX), *(ExportFolder / FileNameFBX));
-			}
-			else if (FileManager.FileSize(*(ExportFolder / FileNameOBJ)) > 0)
-			{
-				ConvertOBJToFBX(ExportFolder / FileNameOBJ, ImportFolder / FileNameFBX);
-			}
+		FileManager.MakeDirectory(*ImportFolder, true);
+		if (FileManager.FileSize(*(ExportFolder / FileNameFBX)) > 0)
+		{
+			FileManager.Copy(*(ImportFolder / FileNameFBX), *(ExportFolder / FileNameFBX));
 		}
-		else
+		else if (FileManager.FileSize(*(ExportFolder / FileNameOBJ)) > 0)
 		{
-			Task.EnterProgressFrame();
+			ConvertOBJToFBX(ExportFolder / FileNameOBJ, ImportFolder / FileNameFBX);
 		}
 	}
 }
 
+// Text size of the actor blocks parsed in one parallel batch
+static const int32 ActorBatchSize = 16 * 1024 * 1024;
+
 void T3DLevelParser::ImportLevel()
 {
 	FString Class;
+	TArray<T3DActorParser::FActorBlock> Blocks;
+	int32 BlocksSize = 0;
 
 	ensure(NextLine());
 	ensure(Line.Equals(TEXT("Begin Object Class=Level Name=PersistentLevel")));
 
+	// Actor blocks are collected in bounded batches, then parsed in parallel and spawned in level order
 	while (NextLine() && !IsEndObject())
 	{
 		if (IsBeginObject(Class))
 		{
-			UObject * Object = 0;
-			if (Class.Equals(TEXT("StaticMeshActor")))
-				ImportStaticMeshActor();
-			else if (Class.Equals(TEXT("Landscape")))
-				JumpToEnd(); // TODO
-			else if (Class.Equals(TEXT("Brush")))
-				ImportBrush();
-			else if (Class.Equals(TEXT("PointLight")))
-				ImportPointLight();
-			else if (Class.Equals(TEXT("SpotLight")))
-				ImportSpotLight();
+			T3DActorParser::EActorClass::Type ActorClass;
+			if (T3DActorParser::EActorClass::FromName(Class, ActorClass))
+			{
+				T3DActorParser::FActorBlock& Block = Blocks.AddDefaulted_GetRef();
+				Block.Class = ActorClass;
+				ReadBlock(Block.Text);
+
+				BlocksSize += Block.Text.Len();
+				if (BlocksSize >= ActorBatchSize)
+				{
+					ImportActors(Blocks);
+					BlocksSize = 0;
+				}
+			}
 			else
 			{
 				JumpToEnd();
@@ -516,45 +1259,71 @@ void T3DLevelParser::ImportLevel()
 			}
 		}
 	}
+
+	ImportActors(Blocks);
+	FinishDocument();
+}
+
+void T3DLevelParser::ImportActors(TArray<T3DActorParser::FActorBlock> &Blocks)
+{
+	TArray<T3DActorParser::FActor> Actors;
+	T3DActorParser::ParseActors(Blocks, Actors);
+
+	for (const T3DActorParser::FActor &Actor : Actors)
+	{
+		switch (Actor.Class)
+		{
+		case T3DActorParser::EActorClass::StaticMeshActor: SpawnStaticMeshActor(Actor); break;
+		case T3DActorParser::EActorClass::Brush: SpawnBrush(Actor); break;
+		case T3DActorParser::EActorClass::PointLight: SpawnPointLight(Actor); break;
+		case T3DActorParser::EActorClass::SpotLight: SpawnSpotLight(Actor); break;
+		}
+	}
+}
+
+void T3DLevelParser::SetActorProperties(AActor * Actor, const T3DActorParser::FActor &Desc)
+{
+	if (Desc.Location.IsSet())
+		Actor->SetActorLocation(Desc.Location.GetValue());
+	if (Desc.Rotation.IsSet())
+		Actor->SetActorRotation(Desc.Rotation.GetValue());
+	if (Desc.Scale3D.IsSet())
+		Actor->SetActorScale3D(Actor->GetActorScale() * Desc.Scale3D.GetValue());
+
+	AddActorToLayers(Actor, Desc);
+}
+
+void T3DLevelParser::AddActorToLayers(AActor * Actor, const T3DActorParser::FActor &Desc)
+{
+	for (const FString &Layer : Desc.Layers)
+	{
+		GEditor->GetEditorSubsystem<ULayersSubsystem>()->AddActorToLayer(Actor, FName(*Layer));
+	}
 }
 
-void T3DLevelParser::ImportBrush()
+void T3DLevelParser::SpawnBrush(const T3DActorParser::FActor &Actor)
 {
-	FString Value, Class, Name;
 	ABrush * Brush = SpawnActor<ABrush>();
-	Brush->BrushType = Brush_Add;
+	Brush->BrushType = Actor.bSubtract ? Brush_Subtract : Brush_Add;
 	UModel* Model = NewObject<UModel>(Brush, NAME_None, RF_Transactional);
 	Model->Initialize(Brush);
 
-	while (NextLine() && !IsEndObject())
+	for (const FPoly &Poly : Actor.Polys)
 	{
-		if (Line.StartsWith(TEXT("Begin Brush ")))
-		{
-			while (NextLine() && !Line.StartsWith(TEXT("End Brush")))
-			{
-				if (Line.StartsWith(TEXT("Begin PolyList")))
-				{
-					ImportPolyList(Model->Polys);
-				}
-			}
-		}
-		else if (GetProperty(TEXT("CsgOper="), Value))
-		{
-			if (Value.Equals(TEXT("CSG_Subtract")))
-			{
-				Brush->BrushType = Brush_Subtract;
-			}
-		}
-		else if (IsActorLocation(Brush) || IsActorProperty(Brush))
-		{
-			continue;
-		}
-		else if (Line.StartsWith(TEXT("Begin "), ESearchCase::CaseSensitive))
+		new(Model->Polys->Element)FPoly(Poly);
+	}
+
+	for (const TPair<FString, int32> &PolyTexture : Actor.PolyTextures)
+	{
+		const int32 Material = RegisterRequirement(FString::Printf(TEXT("Material'%s'"), *PolyTexture.Key));
+		if (Material != INDEX_NONE)
 		{
-			JumpToEnd();
+			PolygonTextureFixups.Add({ Material, Model->Polys, PolyTexture.Value });
 		}
 	}
-	
+
+	SetActorProperties(Brush, Actor);
+
 	Model->Modify();
 	Model->BuildBound();
 
@@ -563,160 +1332,68 @@ void T3DLevelParser::ImportBrush()
 	Brush->PostEditChange();
 }
 
-void T3DLevelParser::ImportPolyList(UPolys * Polys)
+void T3DLevelParser::SpawnPointLight(const T3DActorParser::FActor &Actor)
 {
-	FString Texture;
-	while (NextLine() && !Line.StartsWith(TEXT("End PolyList")))
-	{
-		if (Line.StartsWith(TEXT("Begin Polygon ")))
-		{
-			bool GotBase = false;
-			FPoly Poly;
-			if (GetOneValueAfter(TEXT(" Texture="), Texture))
-			{
-				AddRequirement(FString::Printf(TEXT("Material'%s'"), *Texture), UObjectDelegate::CreateRaw(this, &T3DLevelParser::SetPolygonTexture, Polys, Polys->Element.Num()));
-			}
-			FParse::Value(*Line, TEXT("LINK="), Poly.iLink);
-			Poly.PolyFlags &= ~PF_NoImport;
+	APointLight* PointLight = SpawnActor<APointLight>();
 
-			while (NextLine() && !Line.StartsWith(TEXT("End Polygon")))
-			{
-				const TCHAR* Str = *Line;
-				if (FParse::Command(&Str, TEXT("ORIGIN")))
-				{
-					GotBase = true;
-					ParseFVector(Str, Poly.Base);
-				}
-				else if (FParse::Command(&Str, TEXT("VERTEX")))
-				{
-					FVector TempVertex;
-					ParseFVector(Str, TempVertex);
-					new(Poly.Vertices) FVector(TempVertex);
-				}
-				else if (FParse::Command(&Str, TEXT("TEXTUREU")))
-				{
-					ParseFVector(Str, Poly.TextureU);
-				}
-				else if (FParse::Command(&Str, TEXT("TEXTUREV")))
-				{
-					ParseFVector(Str, Poly.TextureV);
-				}
-				else if (FParse::Command(&Str, TEXT("NORMAL")))
-				{
-					ParseFVector(Str, Poly.Normal);
-				}
-			}
-			if (!GotBase)
-				Poly.Base = Poly.Vertices[0];
-			if (Poly.Finalize(NULL, 1) == 0)
-				new(Polys->Element)FPoly(Poly);
-		}
-	}
+	if (Actor.Radius.IsSet())
+		PointLight->PointLightComponent->AttenuationRadius = Actor.Radius.GetValue();
+	if (Actor.Brightness.IsSet())
+		PointLight->PointLightComponent->Intensity = Actor.Brightness.GetValue() * IntensityMultiplier;
+	if (Actor.LightColor.IsSet())
+		PointLight->PointLightComponent->LightColor = Actor.LightColor.GetValue();
+
+	SetActorProperties(PointLight, Actor);
+	PointLight->PostEditChange();
 }
 
-void T3DLevelParser::ImportPointLight()
+void T3DLevelParser::SpawnSpotLight(const T3DActorParser::FActor &Actor)
 {
-	FString Value, Class;
-	APointLight* PointLight = SpawnActor<APointLight>();
+	ASpotLight* SpotLight = SpawnActor<ASpotLight>();
 
-	while (NextLine() && !IsEndObject())
-	{
-		if (IsBeginObject(Class))
-		{
-			if (Class.Equals(TEXT("SpotLightComponent")))
-			{
-				while (NextLine() && IgnoreSubs() && !IsEndObject())
-				{
-					if (GetProperty(TEXT("Radius="), Value))
-					{
-						PointLight->PointLightComponent->AttenuationRadius = FCString::Atof(*Value);
-					}
-					else if (GetProperty(TEXT("Brightness="), Value))
-					{
-						PointLight->PointLightComponent->Intensity = FCString::Atof(*Value) * IntensityMultiplier;
-					}
-					else if (GetProperty(TEXT("LightColor="), Value))
-					{
-						FColor Color;
-						Color.InitFromString(Value);
-						PointLight->PointLightComponent->LightColor = Color;
-					}
-				}
-			}
-			else
-			{
-				JumpToEnd();
-			}
-		}
-		else if (IsActorLocation(PointLight) || IsActorRotation(PointLight) || IsActorProperty(PointLight))
-		{
-			continue;
-		}
-	}
-	PointLight->PostEditChange();
+	if (Actor.Radius.IsSet())
+		SpotLight->SpotLightComponent->AttenuationRadius = Actor.Radius.GetValue();
+	if (Actor.InnerConeAngle.IsSet())
+		SpotLight->SpotLightComponent->InnerConeAngle = Actor.InnerConeAngle.GetValue();
+	if (Actor.OuterConeAngle.IsSet())
+		SpotLight->SpotLightComponent->OuterConeAngle = Actor.OuterConeAngle.GetValue();
+	if (Actor.Brightness.IsSet())
+		SpotLight->SpotLightComponent->Intensity = Actor.Brightness.GetValue() * IntensityMultiplier;
+	if (Actor.LightColor.IsSet())
+		SpotLight->SpotLightComponent->LightColor = Actor.LightColor.GetValue();
+
+	if (Actor.Location.IsSet())
+		SpotLight->SetActorLocation(Actor.Location.GetValue());
+	AddActorToLayers(SpotLight, Actor);
+
+	// Because there is people that does this in UDK...
+	const FVector DrawScale3D = Actor.Scale3D.Get(FVector(1.0, 1.0, 1.0));
+	const FRotator Rotator = Actor.Rotation.Get(FRotator(0.0, 0.0, 0.0));
+	SpotLight->SetActorRotation((DrawScale3D.X * Rotator.Vector()).Rotation());
+	SpotLight->PostEditChange();
 }
 
-void T3DLevelParser::ImportSpotLight()
+void T3DLevelParser::SpawnStaticMeshActor(const T3DActorParser::FActor &Actor)
 {
-	FVector DrawScale3D(1.0,1.0,1.0);
-	FRotator Rotator(0.0, 0.0, 0.0);
-	FString Value, Class, Name;
-	ASpotLight* SpotLight = SpawnActor<ASpotLight>();
+	AStaticMeshActor * StaticMeshActor = SpawnActor<AStaticMeshActor>();
 
-	while (NextLine() && !IsEndObject())
+	for (const FString &StaticMesh : Actor.StaticMeshes)
 	{
-		if (IsBeginObject(Class))
-		{
-			if (Class.Equals(TEXT("SpotLightComponent")))
-			{
-				while (NextLine() && IgnoreSubs() && !IsEndObject())
-				{
-					if (GetProperty(TEXT("Radius="), Value))
-					{
-						SpotLight->SpotLightComponent->AttenuationRadius = FCString::Atof(*Value);
-					}
-					else if (GetProperty(TEXT("InnerConeAngle="), Value))
-					{
-						SpotLight->SpotLightComponent->InnerConeAngle = FCString::Atof(*Value);
-					}
-					else if (GetProperty(TEXT("OuterConeAngle="), Value))
-					{
-						SpotLight->SpotLightComponent->OuterConeAngle = FCString::Atof(*Value);
-					}
-					else if (GetProperty(TEXT("Brightness="), Value))
-					{
-						SpotLight->SpotLightComponent->Intensity = FCString::Atof(*Value) * IntensityMultiplier;
-					}
-					else if (GetProperty(TEXT("LightColor="), Value))
-					{
-						FColor Color;
-						Color.InitFromString(Value);
-						SpotLight->SpotLightComponent->LightColor = Color;
-					}
-				}
-			}
-			else
-			{
-				JumpToEnd();
-			}
-		}
-		else if (IsActorLocation(SpotLight) || IsActorProperty(SpotLight))
-		{
-			continue;
-		}
-		else if (GetProperty(TEXT("Rotation="), Value))
-		{
-			ensure(ParseUDKRotation(Value, Rotator));
-		}
-		else if (GetProperty(TEXT("DrawScale3D="), Value))
+		const int32 StaticMeshIndex = RegisterRequirement(StaticMesh);
+		if (StaticMeshIndex != INDEX_NONE)
 		{
-			ensure(DrawScale3D.InitFromString(Value));
+			StaticMeshFixups.Add({ StaticMeshIndex, StaticMeshActor->GetStaticMeshComponent() });
 		}
 	}
 
-	// Because there is people that does this in UDK...
-	SpotLight->SetActorRotation((DrawScale3D.X * Rotator.Vector()).Rotation());
-	SpotLight->PostEditChange();
+	SetActorProperties(StaticMeshActor, Actor);
+
+	if (Actor.PrePivot.IsSet())
+	{
+		FVector PrePivot = StaticMeshActor->GetActorRotation().RotateVector(Actor.PrePivot.GetValue());
+		StaticMeshActor->SetActorLocation(StaticMeshActor->GetActorLocation() - PrePivot);
+	}
+	StaticMeshActor->PostEditChange();
 }
 
 void T3DLevelParser::ImportDynamic(const FString& ClassName, UObject* Parent)
@@ -757,51 +1434,6 @@ void T3DLevelParser::ImportDynamic(const FString& ClassName, UObject* Parent)
 	}
 }
 
-void T3DLevelParser::ImportStaticMeshActor()
-{
-	FString Value, Class;
-	FVector PrePivot;
-	bool bPrePivotFound = false;
-	AStaticMeshActor * StaticMeshActor = SpawnActor<AStaticMeshActor>();
-	
-	while (NextLine() && !IsEndObject())
-	{
-		if (IsBeginObject(Class))
-		{
-			if (Class.Equals(TEXT("StaticMeshComponent")))
-			{
-				while (NextLine() && !IsEndObject())
-				{
-					if (GetProperty(TEXT("StaticMesh="), Value))
-					{
-						AddRequirement(Value, UObjectDelegate::CreateRaw(this, &T3DLevelParser::SetStaticMesh, StaticMeshActor->GetStaticMeshComponent()));
-					}
-				}
-			}
-			else
-			{
-				JumpToEnd();
-			}
-		}
-		else if (IsActorLocation(StaticMeshActor) || IsActorRotation(StaticMeshActor) || IsActorScale(StaticMeshActor) || IsActorProperty(StaticMeshActor))
-		{
-			continue;
-		}
-		else if (GetProperty(TEXT("PrePivot="), Value))
-		{
-			ensure(PrePivot.InitFromString(Value));
-			bPrePivotFound = true;
-		}
-	}
-
-	if (bPrePivotFound)
-	{
-		PrePivot = StaticMeshActor->GetActorRotation().RotateVector(PrePivot);
-		StaticMeshActor->SetActorLocation(StaticMeshActor->GetActorLocation() - PrePivot);
-	}
-	StaticMeshActor->PostEditChange();
-}
-
 void T3DLevelParser::ImportLandscape()
 {
 	FString Class, Value;
@@ -817,7 +1449,7 @@ void T3DLevelParser::ImportLandscape()
 			if (Class.Equals(TEXT("LandscapeComponent")))
 			{
 				FString Name;
-				if (!GetOneValueAfter(" Name=", Name))
+				if (!GetOneValueAfter(TEXT(" Name="), Name))
 				{
 					JumpToEnd();
 					continue;
@@ -830,7 +1462,7 @@ void T3DLevelParser::ImportLandscape()
 
 				while (NextLine() && IgnoreSubs() && !IsEndObject())
 				{
-					if (GetProperty(TEXT("HeightmapTexture="), Value))
+					if (GetProperty(TEXT("HeightmapTexture"), Value))
 						AddRequirement(Value, UObjectDelegate::CreateRaw(this, &T3DLevelParser::SetHeightmapTexture, Component));
 				}
 
@@ -855,11 +1487,11 @@ USoundCue * T3DLevelParser::ImportSoundCue()
 
 	while (NextLine())
 	{
-		if (GetProperty(TEXT("SoundClass="), Value))
+		if (GetProperty(TEXT("SoundClass"), Value))
 		{
 			// TODO
 		}
-		else if (GetProperty(TEXT("FirstNode="), Value))
+		else if (GetProperty(TEXT("FirstNode"), Value))
 		{
 			AddRequirement(Value, UObjectDelegate::CreateRaw(this, &T3DLevelParser::SetSoundCueFirstNode, SoundCue));
 		}
@@ -897,11 +1529,6 @@ void T3DLevelParser::SetSoundCueFirstNode(UObject * Object, USoundCue * SoundCue
 	SoundCue->FirstNode = Cast<USoundNode>(Object);
 }
 
-void T3DLevelParser::SetStaticMeshMaterial(UObject * Material, FString StaticMeshUrl, int32 MaterialIdx)
-{
-	AddRequirement(StaticMeshUrl, UObjectDelegate::CreateRaw(this, &T3DLevelParser::SetStaticMeshMaterialResolved, Material, MaterialIdx));
-}
-
 void T3DLevelParser::SetStaticMeshMaterialResolved(UObject * Object, UObject * Material, int32 MaterialIdx)
 {
 	UStaticMesh * StaticMesh = Cast<UStaticMesh>(Object);
@@ -912,9 +1539,6 @@ void T3DLevelParser::SetStaticMeshMaterialResolved(UObject * Object, UObject * M
 	Info.MaterialIndex = MaterialIdx;
 	StaticMesh->GetSectionInfoMap().Set(0, MaterialIdx, Info);
 	StaticMesh->SetMaterial(MaterialIdx, Cast<UMaterialInterface>(Material));
-
-	StaticMesh->Modify();
-	StaticMesh->PostEditChange();
 }
 
 void T3DLevelParser::SetTexture(UObject * Object, UMaterialExpressionTextureBase * MaterialExpression)
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "T3DParser.h"
+#include "T3DActorParser.h"
+#include "UDKCommandletPool.h"
 
 class T3DMaterialParser;
 class T3DMaterialInstanceConstantParser;
@@ -30,21 +32,76 @@ private:
 			Texture2DInfo
 		};
 	};
+	UDKCommandletPool ExportPool;
+	TSet<FString> FailedExports; // Export folders of the packages UDK could not export
+	int32 UDKOutputCount;
+	TMap<FString, FString> PackageFiles; // Package name -> .upk/.udk file
+	TMap<FString, FString> PackageFingerprints; // Package name -> fingerprint, read once per import
+	bool bPackageFilesIndexed;
 	FString ExportFolderFor(EExportType::Type Type);
 	FString RessourceTypeFor(EExportType::Type Type);
 	void ImportRessource(const FString &Ressource, EExportType::Type Type);
+	struct EExportMode
+	{
+		enum Type
+		{
+			Package, // batchexport of whole packages
+			Object // Only the required objects
+		};
+	};
+	/** Export of a package or of one of its objects, as given to the export commandlets */
+	struct FExportEntry
+	{
+		FString Entry; // Package|Class|Format|Folder or Class|ObjectPath|File
+		FString ExportFolder;
+		FString Object, FileName; // Empty for packages
+	};
+	bool ExportFormatFor(EExportType::Type Type, FString &Class, FString &Format);
+	bool PackageExportFor(const FString &Package, EExportType::Type Type, FExportEntry &Export);
+	bool ObjectExportFor(const FRequirement &Requirement, EExportType::Type Type, FExportEntry &Export);
 	bool ExportPackage(const FString &Package, EExportType::Type Type, FString & ExportFolder);
+	bool ExportRequirement(const FRequirement &Requirement, EExportType::Type Type, FString & ExportFolder);
+	void IndexPackageFiles();
+	FString PackageFingerprint(const FString &Package);
+	TMap<FString, TSet<FString>> ExportedObjects; // Export folder -> objects of its fingerprint file, read once per import
+	TSet<FString>& GetExportedObjects(const FString &ExportFolder);
+	bool IsExported(const FString &ExportFolder, const FString &Object = FString());
+	void SetExported(const FExportEntry &Export, bool bSuccess);
+	void ExportPackagesFor(EExportType::Type Type, const TArray<TPair<FRequirement, FRequirementFixups>*> &Wave);
+	FString NewUDKOutputFile(const TCHAR * Prefix, FString &Name);
+	void BulkExport(EExportMode::Type Mode, const TArray<FExportEntry> &Exports);
+	void ReadBulkExportManifest(const UDKCommandletPool::FJob &Job, FString ManifestFileName, TArray<FExportEntry> Exports);
 	void ExportPackageToRequirements(const FString &Package, EExportType::Type Type);
 
 	/// Ressources requirements
 	void ResolveRequirements(FScopedSlowTask& Task);
+	void ExportDependencies();
+	void ReadDependencies(const UDKCommandletPool::FJob &Job, FString OutputFileName);
+	void AddDependency(const FString &Record);
 	void ExportStaticMeshRequirements();
-	void ExportStaticMeshRequirements(const FString &StaticMeshesParams);
+	void ReadStaticMeshMaterials(const UDKCommandletPool::FJob &Job, FString OutputFileName);
+	void AddStaticMeshMaterial(const FString &Record, FString StaticMeshUrl);
+	struct FImportedAsset
+	{
+		FString ObjectPath, Fingerprint;
+	};
+	TMap<FString, FImportedAsset> ImportManifest; // Requirement Url -> imported asset
+	TSet<FString> StaleImports; // Requirement Urls whose package changed since they were imported
+	bool bImportManifestLoaded;
+	void LoadImportManifest();
+	void SaveImportManifest();
+	void ResolveImported(const TArray<TPair<FRequirement, FRequirementFixups>*> &Wave, TArray<TPair<FRequirement, FRequirementFixups>*> &OutUnresolved);
+	UObject * FindPreviousImport(const FRequirement &Requirement, const FString &ObjectPath, bool &bOutStale);
+	TMap<FString, FString> MaterialParents; // MaterialInstanceConstant Url -> parent Url, from the dependency walk
+	TArray<UObject*> ParsedMaterials; // Materials and MaterialInstanceConstants parsed by this import, the only ones compiled
+	void SortByParents(const TArray<TPair<FRequirement, FRequirementFixups>*> &Instances, TArray<TPair<FRequirement, FRequirementFixups>*> &OutWave);
 	void ExportMaterialInstanceConstantAssets();
 	void ExportMaterialAssets();
 	void ExportTextureAssets();
 	void ExportStaticMeshAssets();
-	void PostEditChangeFor(const FString &Type);
+	void CompileMaterials();
+	TSet<UObject*> ChangedStaticMeshes; // StaticMeshes imported or modified by this import, the only ones rebuilt
+	int32 PostEditChangeFor(ERequirementType::Type Kind, TSet<UObject*> &Changed);
 
 	/// Actor creation
 	UWorld * World;
@@ -55,21 +112,54 @@ private:
 
 	/// Actor Importation
 	void ImportLevel();
-	void ImportBrush();
-	void ImportPolyList(UPolys * Polys);
-	void ImportStaticMeshActor();
+	void ImportActors(TArray<T3DActorParser::FActorBlock> &Blocks);
 	void ImportLandscape();
-	void ImportPointLight();
-	void ImportSpotLight();
+
+	/// Actor spawning, game thread only
+	void SpawnBrush(const T3DActorParser::FActor &Actor);
+	void SpawnStaticMeshActor(const T3DActorParser::FActor &Actor);
+	void SpawnPointLight(const T3DActorParser::FActor &Actor);
+	void SpawnSpotLight(const T3DActorParser::FActor &Actor);
+	void SetActorProperties(AActor * Actor, const T3DActorParser::FActor &Desc);
+	void AddActorToLayers(AActor * Actor, const T3DActorParser::FActor &Desc);
 	void ImportDynamic(const FString& ClassName, UObject* Parent);
 	USoundCue * ImportSoundCue();
 
+	/// Fixups of the frequent references, plain records applied by kind once the requirements are resolved
+	struct FStaticMeshFixup
+	{
+		int32 StaticMesh; // Index in Requirements
+		UStaticMeshComponent * Component;
+	};
+	struct FPolygonTextureFixup
+	{
+		int32 Material;
+		UPolys * Polys;
+		int32 PolyIndex;
+	};
+	struct FTextureParameterFixup
+	{
+		int32 Texture;
+		UMaterialInstanceConstant * MaterialInstanceConstant;
+		int32 ParameterIndex;
+	};
+	struct FStaticMeshMaterialFixup
+	{
+		int32 Material, StaticMesh;
+		int32 MaterialIdx;
+	};
+	TArray<FStaticMeshFixup> StaticMeshFixups;
+	TArray<FPolygonTextureFixup> PolygonTextureFixups;
+	TArray<FTextureParameterFixup> TextureParameterFixups;
+	TArray<FStaticMeshMaterialFixup> StaticMeshMaterialFixups;
+	void AddStaticMeshMaterialFixup(const FString &MaterialUrl, const FString &StaticMeshUrl, int32 MaterialIdx);
+	void ApplyFixups();
+
 	/// Available ressource actions
 	void SetStaticMesh(UObject * Object, UStaticMeshComponent * StaticMeshComponent);
 	void SetHeightmapTexture(UObject* Object, ULandscapeComponent* Component);
 	void SetPolygonTexture(UObject * Object, UPolys * Polys, int32 index);
 	void SetSoundCueFirstNode(UObject * Object, USoundCue * SoundCue);
-	void SetStaticMeshMaterial(UObject * Material, FString StaticMeshUrl, int32 MaterialIdx);
 	void SetStaticMeshMaterialResolved(UObject * Object, UObject * Material, int32 MaterialIdx);
 	void SetTexture(UObject * Object, UMaterialExpressionTextureBase * MaterialExpression);
 	void SetParent(UObject * Object, UMaterialInstanceConstant * MaterialInstanceConstant);
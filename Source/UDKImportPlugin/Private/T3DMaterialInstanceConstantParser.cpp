@@ -2,6 +2,7 @@
 
 #include "UDKImportPluginPrivatePCH.h"
 #include "T3DLevelParser.h"
+#include "T3DNumberParser.h"
 
 T3DMaterialInstanceConstantParser::T3DMaterialInstanceConstantParser(T3DLevelParser * ParentParser, const FString &Package) : T3DParser(ParentParser->UdkPath, ParentParser->TmpPath)
 {
@@ -10,14 +11,15 @@ T3DMaterialInstanceConstantParser::T3DMaterialInstanceConstantParser(T3DLevelPar
 	this->MaterialInstanceConstant = NULL;
 }
 
-UMaterialInstanceConstant* T3DMaterialInstanceConstantParser::ImportT3DFile(const FString &FileName)
+UMaterialInstanceConstant* T3DMaterialInstanceConstantParser::ImportT3DFile(const FString &FileName, UMaterialInstanceConstant * PreviousImport)
 {
-	FString MaterialT3D;
-	if (FFileHelper::LoadFileToString(MaterialT3D, *FileName))
+	if (ResetParserFromFile(FileName))
 	{
-		ResetParser(MaterialT3D);
-		MaterialT3D.Empty();
-		return ImportMaterialInstanceConstant();
+		MaterialInstanceConstant = PreviousImport;
+		UMaterialInstanceConstant * MaterialInstanceConstant = ImportMaterialInstanceConstant();
+		if (MaterialInstanceConstant != NULL)
+			FinishDocument();
+		return MaterialInstanceConstant;
 	}
 
 	return NULL;
@@ -33,16 +35,26 @@ UMaterialInstanceConstant*  T3DMaterialInstanceConstantParser::ImportMaterialIns
 	ensure(ClassName == TEXT("MaterialInstanceConstant"));
 	ensure(GetOneValueAfter(TEXT(" Name="), Name));
 
-	FString BasePackageName = FString::Printf(TEXT("/Game/UDK/%s/MaterialInstances"), *Package);
-	FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
-	UMaterialInstanceConstantFactoryNew* MaterialFactory = NewObject<UMaterialInstanceConstantFactoryNew>(UMaterialInstanceConstantFactoryNew::StaticClass());
-	MaterialInstanceConstant = (UMaterialInstanceConstant*)AssetToolsModule.Get().CreateAsset(Name, BasePackageName, UMaterialInstanceConstant::StaticClass(), MaterialFactory);
-	if (MaterialInstanceConstant == NULL)
+	if (MaterialInstanceConstant)
 	{
-		return NULL;
+		// Imported again, the parameters and the parent are cleared so only the new export remains
+		MaterialInstanceConstant->Modify();
+		MaterialInstanceConstant->ClearParameterValuesEditorOnly();
+		MaterialInstanceConstant->SetParentEditorOnly(NULL);
 	}
+	else
+	{
+		FString BasePackageName = FString::Printf(TEXT("/Game/UDK/%s/MaterialInstances"), *Package);
+		FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
+		UMaterialInstanceConstantFactoryNew* MaterialFactory = NewObject<UMaterialInstanceConstantFactoryNew>(UMaterialInstanceConstantFactoryNew::StaticClass());
+		MaterialInstanceConstant = (UMaterialInstanceConstant*)AssetToolsModule.Get().CreateAsset(Name, BasePackageName, UMaterialInstanceConstant::StaticClass(), MaterialFactory);
+		if (MaterialInstanceConstant == NULL)
+		{
+			return NULL;
+		}
 
-	MaterialInstanceConstant->Modify();
+		MaterialInstanceConstant->Modify();
+	}
 
 	while (NextLine() && IgnoreSubObjects() && !IsEndObject())
 	{
@@ -63,7 +75,7 @@ UMaterialInstanceConstant*  T3DMaterialInstanceConstantParser::ImportMaterialIns
 				FRequirement Requirement;
 				if (ParseResourceUrl(Value, Requirement))
 				{
-					LevelParser->AddRequirement(Requirement, UObjectDelegate::CreateRaw(LevelParser, &T3DLevelParser::SetTextureParameterValue, MaterialInstanceConstant, ParameterIndex));
+					LevelParser->TextureParameterFixups.Add({ LevelParser->RegisterRequirement(Requirement), MaterialInstanceConstant, ParameterIndex });
 				}
 				else
 				{
@@ -96,11 +108,11 @@ UMaterialInstanceConstant*  T3DMaterialInstanceConstantParser::ImportMaterialIns
 			Parameter.ExpressionGUID = FGuid::NewGuid();
 
 			if (GetOneValueAfter(TEXT("ParameterValue="), Value))
-				Parameter.ParameterValue.InitFromString(Value);
+				T3DNumberParser::ParseLinearColor(*Value, Parameter.ParameterValue);
 			if (GetOneValueAfter(TEXT("ParameterName="), Value))
 				Parameter.ParameterInfo.Name = *Value;
 		}
-		else if (GetProperty(TEXT("Parent="), Value))
+		else if (GetProperty(TEXT("Parent"), Value))
 		{
 			FRequirement Requirement;
 			if (ParseResourceUrl(Value, Requirement))
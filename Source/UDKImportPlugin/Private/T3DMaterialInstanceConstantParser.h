@@ -8,7 +8,7 @@ class T3DMaterialInstanceConstantParser : public T3DParser
 {
 public:
 	T3DMaterialInstanceConstantParser(T3DLevelParser * ParentParser, const FString &Package);
-	UMaterialInstanceConstant * ImportT3DFile(const FString &FileName);
+	UMaterialInstanceConstant * ImportT3DFile(const FString &FileName, UMaterialInstanceConstant * PreviousImport = NULL);
 
 private:
 	T3DLevelParser * LevelParser;
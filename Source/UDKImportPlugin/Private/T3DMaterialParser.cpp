@@ -17,14 +17,15 @@ T3DMaterialParser::T3DMaterialParser(T3DLevelParser * ParentParser, const FStrin
 	this->Material = NULL;
 }
 
-UMaterial* T3DMaterialParser::ImportMaterialT3DFile(const FString &FileName)
+UMaterial* T3DMaterialParser::ImportMaterialT3DFile(const FString &FileName, UMaterial * PreviousImport)
 {
-	FString MaterialT3D;
-	if (FFileHelper::LoadFileToString(MaterialT3D, *FileName))
+	if (ResetParserFromFile(FileName))
 	{
-		ResetParser(MaterialT3D);
-		MaterialT3D.Empty();
-		return ImportMaterial();
+		Material = PreviousImport;
+		UMaterial * Material = ImportMaterial();
+		if (Material != NULL)
+			FinishDocument();
+		return Material;
 	}
 
 	return NULL;
@@ -66,16 +67,25 @@ UMaterial*  T3DMaterialParser::ImportMaterial()
 	ensure(ClassName == TEXT("Material"));
 	ensure(GetOneValueAfter(TEXT(" Name="), MaterialName));
 
-	FString BasePackageName = FString::Printf(TEXT("/Game/UDK/%s/Materials"), *Package);
-	FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
-	UMaterialFactoryNew* MaterialFactory = NewObject<UMaterialFactoryNew>(UMaterialFactoryNew::StaticClass());
-	Material = (UMaterial*)AssetToolsModule.Get().CreateAsset(MaterialName, BasePackageName, UMaterial::StaticClass(), MaterialFactory);
-	if (Material == NULL)
+	if (Material)
 	{
-		return NULL;
+		// Imported again, the material is cleared so only the new export remains
+		Material->Modify();
+		ResetMaterial();
 	}
+	else
+	{
+		FString BasePackageName = FString::Printf(TEXT("/Game/UDK/%s/Materials"), *Package);
+		FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
+		UMaterialFactoryNew* MaterialFactory = NewObject<UMaterialFactoryNew>(UMaterialFactoryNew::StaticClass());
+		Material = (UMaterial*)AssetToolsModule.Get().CreateAsset(MaterialName, BasePackageName, UMaterial::StaticClass(), MaterialFactory);
+		if (Material == NULL)
+		{
+			return NULL;
+		}
 
-	Material->Modify();
+		Material->Modify();
+	}
 	while (NextLine() && !IsEndObject())
 	{
 		if (IsBeginObject(ClassName))
@@ -115,35 +125,35 @@ UMaterial*  T3DMaterialParser::ImportMaterial()
 				JumpToEnd();
 			}
 		}
-		else if (GetProperty(TEXT("DiffuseColor="), Value))
+		else if (GetProperty(TEXT("DiffuseColor"), Value))
 		{
 			ImportExpression(&Material->BaseColor);
 		}
-		else if (GetProperty(TEXT("SpecularColor="), Value))
+		else if (GetProperty(TEXT("SpecularColor"), Value))
 		{
 			ImportExpression(&Material->Specular);
 		}
-		else if (GetProperty(TEXT("SpecularPower="), Value))
+		else if (GetProperty(TEXT("SpecularPower"), Value))
 		{
 			// TODO
 		}
-		else if (GetProperty(TEXT("Normal="), Value))
+		else if (GetProperty(TEXT("Normal"), Value))
 		{
 			ImportExpression(&Material->Normal);
 		}
-		else if (GetProperty(TEXT("EmissiveColor="), Value))
+		else if (GetProperty(TEXT("EmissiveColor"), Value))
 		{
 			ImportExpression(&Material->EmissiveColor);
 		}
-		else if (GetProperty(TEXT("Opacity="), Value))
+		else if (GetProperty(TEXT("Opacity"), Value))
 		{
 			ImportExpression(&Material->Opacity);
 		}
-		else if (GetProperty(TEXT("OpacityMask="), Value))
+		else if (GetProperty(TEXT("OpacityMask"), Value))
 		{
 			ImportExpression(&Material->OpacityMask);
 		}
-		else if (GetProperty(TEXT("PreviewMesh="), Value))
+		else if (GetProperty(TEXT("PreviewMesh"), Value))
 		{
 			// TODO: Add requirement.
 		}
@@ -162,6 +172,26 @@ UMaterial*  T3DMaterialParser::ImportMaterial()
 	return Material;
 }
 
+void T3DMaterialParser::ResetMaterial()
+{
+	// Graph
+	Material->Expressions.Empty();
+	Material->EditorComments.Empty();
+	for (int32 Property = 0; Property < MP_MAX; ++Property)
+	{
+		if (FExpressionInput * Input = Material->GetExpressionInputForProperty((EMaterialProperty)Property))
+			Input->Expression = NULL;
+	}
+
+	// Properties the export may set, those it leaves out are back to their default
+	const UMaterial * Default = GetDefault<UMaterial>();
+	for (TFieldIterator<FProperty> It(UMaterial::StaticClass(), EFieldIteratorFlags::ExcludeSuper); It; ++It)
+	{
+		if (It->HasAnyPropertyFlags(CPF_Edit))
+			It->CopyCompleteValue_InContainer(Material, Default);
+	}
+}
+
 UMaterialExpression* T3DMaterialParser::ImportMaterialExpression(UClass * Class, FRequirement &TextureRequirement)
 {
 	if (!Class->IsChildOf(UMaterialExpression::StaticClass()))
@@ -173,7 +203,7 @@ UMaterialExpression* T3DMaterialParser::ImportMaterialExpression(UClass * Class,
 	FString Value, Name, PropertyName, Type, PackageName;
 	while (NextLine() && IgnoreSubs() && !IsEndObject())
 	{
-		if (GetProperty(TEXT("Texture="), Value))
+		if (GetProperty(TEXT("Texture"), Value))
 		{
 			auto MaterialExpressionTexture = Cast<UMaterialExpressionTextureBase>(MaterialExpression);
 
@@ -189,7 +219,7 @@ UMaterialExpression* T3DMaterialParser::ImportMaterialExpression(UClass * Class,
 				}
 			}
 		}
-		else if (GetProperty(TEXT("Name="), Value))
+		else if (GetProperty(TEXT("Name"), Value))
 		{
 			// Silently ignore. Expressions are not named nowadays (it seems).
 			continue;
@@ -280,9 +310,14 @@ void T3DMaterialParser::ImportMaterialExpressionFlipBookSample(UMaterialExpressi
 
 	FString ExportFolder;
 	FString FileName = TextureRequirement.Name + TEXT(".T3D");
-	LevelParser->ExportPackage(TextureRequirement.Package, T3DLevelParser::EExportType::Texture2DInfo, ExportFolder);
-	if (FFileHelper::LoadFileToString(Line, *(ExportFolder / FileName)))
+	LevelParser->ExportRequirement(TextureRequirement, T3DLevelParser::EExportType::Texture2DInfo, ExportFolder);
+	FString TextureT3D;
+	if (FFileHelper::LoadFileToString(TextureT3D, *(ExportFolder / FileName)))
 	{
+		// Search the whole texture T3D as if it was a single line
+		const FStringView SavedLine = Line;
+		Line = FStringView(*TextureT3D, TextureT3D.Len());
+
 		FString Value;
 		if (GetOneValueAfter(TEXT("HorizontalImages="), Value))
 		{
@@ -292,6 +327,8 @@ void T3DMaterialParser::ImportMaterialExpressionFlipBookSample(UMaterialExpressi
 		{
 			MECRows->R = FCString::Atof(*Value);
 		}
+
+		Line = SavedLine;
 	}
 
 	Expression->Coordinates.OutputIndex = 2;
@@ -8,7 +8,7 @@ class T3DMaterialParser : public T3DParser
 {
 public:
 	T3DMaterialParser(T3DLevelParser * ParentParser, const FString &Package);
-	UMaterial * ImportMaterialT3DFile(const FString &FileName);
+	UMaterial * ImportMaterialT3DFile(const FString &FileName, UMaterial * PreviousImport = NULL);
 
 private:
 	T3DLevelParser * LevelParser;
@@ -16,6 +16,7 @@ private:
 	// T3D Parsing
 	UMaterial * ImportMaterial();
 	UMaterial * Material;
+	void ResetMaterial();
 
 	UMaterialExpression* ImportMaterialExpression(UClass * Class, FRequirement &TextureRequirement);
 	void ImportExpression(FExpressionInput * ExpressionInput);
@@ -2,17 +2,36 @@
 
 #include "CoreMinimal.h"
 
+#include "T3DReader.h"
+
 #define LOCTEXT_NAMESPACE "UDKImportPlugin"
 
 DECLARE_LOG_CATEGORY_EXTERN(UDKImportPluginLog, Log, All);
 DECLARE_DELEGATE_OneParam(UObjectDelegate, UObject*);
 
-class T3DParser
+class UDKExportSession;
+
+class T3DParser : public T3DReader
 {
 public:
+	/** Requirement types with their own export and import phase, every texture class is handled as Texture */
+	struct ERequirementType
+	{
+		enum Type
+		{
+			StaticMesh,
+			Material,
+			MaterialInstanceConstant,
+			Texture,
+			Other,
+			Count
+		};
+	};
+
 	struct FRequirement
 	{
 		FString Type, Package, Name, OriginalUrl, Url;
+		ERequirementType::Type Kind = ERequirementType::Other; // Set when the requirement is added
 
 		FORCEINLINE friend uint32 GetTypeHash(const FRequirement& req)
 		{
@@ -27,20 +46,32 @@ public:
 	};
 
 protected:
-	static float UnrRotToDeg;
 	static float IntensityMultiplier;
 
 	T3DParser(const FString &UdkPath, const FString &TmpPath);
+	virtual ~T3DParser();
 
 	int32 StatusNumerator, StatusDenominator;
 
 	/// UDK
 	FString UdkPath, TmpPath;
+	FString GetUDKExecutable() const;
 	int32 RunUDK(const FString &CommandLine);
-	int32 RunUDK(const FString &CommandLine, FString &output);
+
+	/// UDK export server, kept open for the whole import (UDKImport.UseExportServer)
+	TUniquePtr<UDKExportSession> ExportSession;
+	bool bExportSessionFailed;
+	UDKExportSession * GetExportSession();
 
 	/// Resources requirements
-	TArray<TPair<FRequirement, FRequirementFixups>> Requirements;
+	/// Entries are heap allocated so they keep their address while fixups add new requirements.
+	TIndirectArray<TPair<FRequirement, FRequirementFixups>> Requirements;
+	TMap<FString, int32> RequirementIndices; // Url -> index in Requirements
+	TArray<int32> RequirementBuckets[ERequirementType::Count]; // Indices in Requirements of each type, in insert order
+	TPair<FRequirement, FRequirementFixups>& AddRequirementEntry(const FRequirement &Requirement, const FRequirementFixups &Fixups);
+	static ERequirementType::Type RequirementTypeFor(const FString &Type);
+	/** Appends the requirements of Kind added since Start, returns the Start of the next call */
+	int32 GetRequirementsOfType(ERequirementType::Type Kind, int32 Start, TArray<TPair<FRequirement, FRequirementFixups>*> &OutRequirements);
 
 	bool FindRequirement(const FRequirement &Requirement, UObject * &Object);
 	TPair<FRequirement, FRequirementFixups>* FindRequirement(const FRequirement& Requirement);
@@ -50,36 +81,14 @@ protected:
 	void FixRequirement(const FString& UDKRequiredObjectName, UObject* Object);
 	bool FindRequirement(const FString &UDKRequiredObjectName, UObject * &Object);
 	void AddRequirement(const FRequirement &Requirement, UObjectDelegate Action);
+	/** Adds the requirement without action if it is new, returns its index in Requirements or INDEX_NONE */
+	int32 RegisterRequirement(const FString &UDKRequiredObjectName);
+	int32 RegisterRequirement(const FRequirement &Requirement);
 	void FixRequirement(TPair<FRequirement, FRequirementFixups>& Pair, UObject* Object);
 	void PrintMissingRequirements();
 
-	/// Line parsing
-	int32 LineIndex, ParserLevel;
-	TArray<FString> Lines;
-	FString Line, Package;
-	void ResetParser(const FString &Content);
-	bool NextLine();
-	bool IgnoreSubs();
-	bool IgnoreSubObjects();
-	void JumpToEnd();
-
-	/// Line content parsing
-	bool IsBeginObject(FString &Class);
-	bool IsEndObject();
-	bool IsProperty(FString &PropertyName, FString &Value);
-	bool IsParameter(const FString& Key, int32& index, FString& Value);
-	bool IsActorLocation(AActor * Actor);
-	bool IsActorRotation(AActor * Actor);
-	bool IsActorScale(AActor * Actor);
-	bool IsActorProperty(AActor * Actor);
-
 	/// Value parsing
-	bool GetOneValueAfter(const FString &Key, FString &Value, int32 maxindex = MAX_int32);
-	bool GetProperty(const FString &Key, FString &Value);
-	bool ParseUDKRotation(const FString &InSourceString, FRotator &Rotator);
-	bool ParseFVector(const TCHAR* Stream, FVector& Value);
-	void ParseResourceUrl(const FString &Url, FString &Package, FString &Name);
-	bool ParseResourceUrl(const FString &Url, FString &Type, FString &Package, FString &Name);
+	using T3DReader::ParseResourceUrl;
 	bool ParseResourceUrl(const FString &Url, FRequirement &Requirement);
 };
 
@@ -98,8 +107,3 @@ FORCEINLINE bool T3DParser::ParseResourceUrl(const FString &Url, FRequirement &R
 	}
 	return false;
 }
-
-FORCEINLINE bool T3DParser::GetProperty(const FString &Key, FString &Value)
-{
-	return GetOneValueAfter(Key, Value, 0);
-}
@@ -0,0 +1,160 @@
+#include "UDKCommandletPool.h"
+
+#include "UDKImportPluginPrivatePCH.h"
+#include "HAL/Event.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/MonitoredProcess.h"
+#include "T3DParser.h"
+
+static TAutoConsoleVariable<int32> CVarMaxProcesses(
+	TEXT("UDKImport.MaxProcesses"),
+	0,
+	TEXT("Number of UDK commandlets run at once by the importer, 0 uses half of the cores"),
+	ECVF_Default);
+
+// Lines of output kept per job for error reports
+static const int32 OutputTailLines = 64;
+
+UDKCommandletPool::UDKCommandletPool(const FString &Executable)
+	: Executable(Executable)
+{
+	MessageEvent = FPlatformProcess::GetSynchEventFromPool(false);
+}
+
+UDKCommandletPool::~UDKCommandletPool()
+{
+	// Process threads post to the queue until they are stopped
+	for (TUniquePtr<FRunningJob> &Job : Running)
+	{
+		Job->Process->Cancel(true);
+	}
+	Running.Empty();
+	FPlatformProcess::ReturnSynchEventToPool(MessageEvent);
+}
+
+int32 UDKCommandletPool::GetMaxProcesses()
+{
+	const int32 MaxProcesses = CVarMaxProcesses.GetValueOnGameThread();
+	if (MaxProcesses > 0)
+		return MaxProcesses;
+
+	return FMath::Max(FPlatformMisc::NumberOfCores() / 2, 1);
+}
+
+bool UDKCommandletPool::Add(const FString &Key, const FString &CommandLine, FOnJobFinished OnFinished, FOnJobOutput OnOutput)
+{
+	bool bAlreadyQueued;
+	Keys.Add(Key, &bAlreadyQueued);
+	if (bAlreadyQueued)
+		return false;
+
+	FRunningJob * Job = new FRunningJob();
+	Job->Job.Key = Key;
+	Job->Job.CommandLine = CommandLine;
+	Job->OnFinished = OnFinished;
+	Job->OnOutput = OnOutput;
+	Pending.Emplace(Job);
+	return true;
+}
+
+void UDKCommandletPool::Wait()
+{
+	if (Pending.Num() == 0 && Running.Num() == 0)
+		return;
+
+	FScopedSlowTask Task(Pending.Num() + Running.Num(), LOCTEXT("StatusRunUDKPool", "Running UDK Commandlets..."));
+	const int32 MaxProcesses = GetMaxProcesses();
+
+	while (Pending.Num() > 0 || Running.Num() > 0)
+	{
+		// Jobs queued from the delegates are run by this same wait
+		Task.TotalAmountOfWork = Task.CompletedWork + Task.CurrentFrameScope + Pending.Num() + Running.Num();
+
+		while (Pending.Num() > 0 && Running.Num() < MaxProcesses)
+		{
+			TUniquePtr<FRunningJob> Job = MoveTemp(Pending[0]);
+			Pending.RemoveAt(0, 1, false);
+
+			if (Start(*Job))
+			{
+				Running.Add(MoveTemp(Job));
+			}
+			else
+			{
+				Task.EnterProgressFrame(1.f, FText::FromString(Job->Job.Key));
+				Finish(*Job, -1);
+			}
+		}
+
+		if (Running.Num() == 0)
+			continue;
+
+		// Wakes up as soon as a process posts a line or exits, the timeout only keeps the dialog responsive
+		MessageEvent->Wait(100);
+		Task.EnterProgressFrame(0.f);
+
+		FMessage Message;
+		while (Messages.Dequeue(Message))
+		{
+			FRunningJob &Job = *Message.Job;
+			if (!Message.bCompleted)
+			{
+				if (Job.Job.OutputTail.Num() >= OutputTailLines)
+				{
+					Job.Job.OutputTail.RemoveAt(0, 1, false);
+				}
+				Job.Job.OutputTail.Add(Message.Line);
+				UE_LOG(UDKImportPluginLog, Verbose, TEXT("UDK: %s"), *Message.Line);
+				Job.OnOutput.ExecuteIfBound(Message.Line);
+				continue;
+			}
+
+			// Completion is posted after the last line of its process
+			const int32 Index = Running.IndexOfByPredicate([&Job](const TUniquePtr<FRunningJob> &Other) { return Other.Get() == &Job; });
+			TUniquePtr<FRunningJob> Finished = MoveTemp(Running[Index]);
+			Running.RemoveAt(Index, 1, false);
+
+			Task.EnterProgressFrame(1.f, FText::FromString(Finished->Job.Key));
+			Finish(*Finished, Message.ReturnCode);
+		}
+	}
+}
+
+bool UDKCommandletPool::Start(FRunningJob &Job)
+{
+	FRunningJob * JobPtr = &Job;
+	Job.Process = MakeUnique<FMonitoredProcess>(Executable, Job.Job.CommandLine, true);
+	Job.Process->OnOutput().BindLambda([this, JobPtr](FString Line)
+	{
+		Line.RemoveFromEnd(TEXT("\r"));
+		Messages.Enqueue({ JobPtr, MoveTemp(Line), false, 0 });
+		MessageEvent->Trigger();
+	});
+	Job.Process->OnCompleted().BindLambda([this, JobPtr](int32 ReturnCode)
+	{
+		Messages.Enqueue({ JobPtr, FString(), true, ReturnCode });
+		MessageEvent->Trigger();
+	});
+
+	if (!Job.Process->Launch())
+	{
+		UE_LOG(UDKImportPluginLog, Error, TEXT("Unable to start UDK : %s %s"), *Executable, *Job.Job.CommandLine);
+		Job.Process.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+void UDKCommandletPool::Finish(FRunningJob &Job, int32 ReturnCode)
+{
+	Job.Job.ReturnCode = ReturnCode;
+	Job.Process.Reset();
+
+	if (ReturnCode != 0)
+	{
+		UE_LOG(UDKImportPluginLog, Error, TEXT("UDK failed with code 0x%08X (%s), last lines of output follow:\n%s"), ReturnCode, *Job.Job.CommandLine, *FString::Join(Job.Job.OutputTail, TEXT("\n")));
+	}
+
+	Job.OnFinished.ExecuteIfBound(Job.Job);
+}
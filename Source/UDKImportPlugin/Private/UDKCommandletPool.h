@@ -0,0 +1,65 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+
+class FMonitoredProcess;
+class FEvent;
+
+/**
+* Runs UDK commandlets in a bounded number of concurrent processes.
+* Jobs are identified by a key, a key queued twice only runs once.
+* Output lines and completions are delivered on the thread that waits for the pool, while the processes run.
+*/
+class UDKCommandletPool
+{
+public:
+	struct FJob
+	{
+		FString Key, CommandLine;
+		TArray<FString> OutputTail; // Last lines of the output, for error reports
+		int32 ReturnCode = -1;
+	};
+
+	DECLARE_DELEGATE_OneParam(FOnJobOutput, const FString&);
+	DECLARE_DELEGATE_OneParam(FOnJobFinished, const FJob&);
+
+	explicit UDKCommandletPool(const FString &Executable);
+	~UDKCommandletPool();
+
+	/** Queues a commandlet, returns false if a job with this key was already queued */
+	bool Add(const FString &Key, const FString &CommandLine, FOnJobFinished OnFinished = FOnJobFinished(), FOnJobOutput OnOutput = FOnJobOutput());
+
+	/** Runs the queued jobs until all of them are finished */
+	void Wait();
+
+	/** Number of processes run at once (UDKImport.MaxProcesses) */
+	static int32 GetMaxProcesses();
+
+private:
+	struct FRunningJob
+	{
+		FJob Job;
+		FOnJobFinished OnFinished;
+		FOnJobOutput OnOutput;
+		TUniquePtr<FMonitoredProcess> Process;
+	};
+
+	/** Output line or completion of a job, posted by the process threads */
+	struct FMessage
+	{
+		FRunningJob * Job;
+		FString Line;
+		bool bCompleted;
+		int32 ReturnCode;
+	};
+
+	bool Start(FRunningJob &Job);
+	void Finish(FRunningJob &Job, int32 ReturnCode);
+
+	FString Executable;
+	TArray<TUniquePtr<FRunningJob>> Pending, Running;
+	TSet<FString> Keys;
+	TQueue<FMessage, EQueueMode::Mpsc> Messages;
+	FEvent * MessageEvent;
+};
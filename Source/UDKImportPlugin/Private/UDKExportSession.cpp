@@ -0,0 +1,156 @@
+#include "UDKExportSession.h"
+
+#include "UDKImportPluginPrivatePCH.h"
+#include "HAL/Event.h"
+#include "Misc/InteractiveProcess.h"
+#include "T3DParser.h"
+
+// Time given to the server to answer quit before it is killed
+static const double QuitTimeout = 10.0;
+
+UDKExportSession::UDKExportSession(const FString &Executable, const FString &Params)
+	: Executable(Executable), Params(Params)
+{
+	NextId = 0;
+	ResponseEvent = FPlatformProcess::GetSynchEventFromPool(false);
+}
+
+UDKExportSession::~UDKExportSession()
+{
+	if (IsRunning())
+	{
+		Send(TEXT("quit"), FOnDone());
+
+		const double Start = FPlatformTime::Seconds();
+		while (!bExited && FPlatformTime::Seconds() - Start < QuitTimeout)
+		{
+			ResponseEvent->Wait(100);
+		}
+	}
+
+	// Stops the process thread before the event it triggers is released
+	Process.Reset();
+	FPlatformProcess::ReturnSynchEventToPool(ResponseEvent);
+}
+
+bool UDKExportSession::Start()
+{
+	Process = MakeUnique<FInteractiveProcess>(Executable, Params, true, true);
+	Process->OnOutput().BindRaw(this, &UDKExportSession::ReceiveOutput);
+	Process->OnCompleted().BindLambda([this](int32 ReturnCode, bool bCanceling)
+	{
+		bExited = true;
+		ResponseEvent->Trigger();
+	});
+
+	if (!Process->Launch())
+	{
+		UE_LOG(UDKImportPluginLog, Error, TEXT("Unable to start the export server : %s %s"), *Executable, *Params);
+		Process.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool UDKExportSession::IsRunning() const
+{
+	return Process.IsValid() && !bExited;
+}
+
+void UDKExportSession::Send(const FString &Request, FOnDone OnDone, FOnData OnData)
+{
+	if (!IsRunning())
+	{
+		OnDone.ExecuteIfBound(-1);
+		return;
+	}
+
+	const int32 Id = NextId++;
+	Outstanding.Add(Id, { OnData, OnDone });
+	Process->SendWhenReady(FString::Printf(TEXT("%d %s"), Id, *Request));
+}
+
+bool UDKExportSession::Wait(int32 MaxOutstanding)
+{
+	while (Outstanding.Num() > MaxOutstanding)
+	{
+		FString Response;
+		if (Responses.Dequeue(Response))
+		{
+			Dispatch(Response);
+		}
+		else if (bExited)
+		{
+			// The last responses may have been queued between the failed Dequeue and the exit
+			if (!Responses.IsEmpty())
+				continue;
+
+			// Every line of the process was handled, the remaining requests will never be answered
+			UE_LOG(UDKImportPluginLog, Error, TEXT("The export server exited with %d unanswered requests"), Outstanding.Num());
+			TMap<int32, FRequest> Unanswered = MoveTemp(Outstanding);
+			for (auto &Request : Unanswered)
+			{
+				Request.Value.OnDone.ExecuteIfBound(-1);
+			}
+			return false;
+		}
+		else
+		{
+			ResponseEvent->Wait(100);
+		}
+	}
+
+	return true;
+}
+
+void UDKExportSession::ReceiveOutput(const FString &Output)
+{
+	// Lines may come in several pieces, a response starts with '@' and ends with ';'
+	if (Output.StartsWith(TEXT("@")))
+	{
+		Partial = Output;
+	}
+	else if (Partial.Len() > 0)
+	{
+		Partial += Output;
+	}
+	else
+	{
+		UE_LOG(UDKImportPluginLog, Verbose, TEXT("Export server: %s"), *Output);
+		return;
+	}
+
+	Partial.TrimEndInline();
+	if (Partial.EndsWith(TEXT(";")))
+	{
+		Responses.Enqueue(MoveTemp(Partial));
+		Partial.Reset();
+		ResponseEvent->Trigger();
+	}
+}
+
+void UDKExportSession::Dispatch(const FString &Response)
+{
+	// @Id > Data; or @Id = ReturnCode;
+	const TCHAR * Id = *Response + 1;
+	const TCHAR * Kind = FCString::Strchr(Id, TCHAR(' '));
+	if (Kind == NULL || (Kind[1] != TCHAR('>') && Kind[1] != TCHAR('=')) || Kind[2] != TCHAR(' '))
+		return;
+
+	FRequest * Request = Outstanding.Find(FCString::Atoi(Id));
+	if (Request == NULL)
+		return;
+
+	const FString Payload(FCString::Strlen(Kind + 3) - 1, Kind + 3);
+	if (Kind[1] == TCHAR('>'))
+	{
+		Request->OnData.ExecuteIfBound(Payload);
+	}
+	else
+	{
+		const FRequest Done = *Request;
+		Outstanding.Remove(FCString::Atoi(Id));
+		Done.OnDone.ExecuteIfBound(FCString::Atoi(*Payload));
+	}
+}
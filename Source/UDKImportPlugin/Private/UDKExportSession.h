@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "HAL/ThreadSafeBool.h"
+
+class FInteractiveProcess;
+class FEvent;
+
+/**
+* Client of a long running export server (ExportServerCommandlet), kept open for a whole import.
+* Requests are lines "Id Command Args", they are pipelined: many can be sent before the first answer.
+* The server answers them in order with "@Id > Data;" lines, then "@Id = ReturnCode;". Other output lines are ignored.
+*/
+class UDKExportSession
+{
+public:
+	DECLARE_DELEGATE_OneParam(FOnData, const FString&);
+	DECLARE_DELEGATE_OneParam(FOnDone, int32);
+
+	UDKExportSession(const FString &Executable, const FString &Params);
+	~UDKExportSession();
+
+	/** Starts the server process */
+	bool Start();
+	bool IsRunning() const;
+
+	/** Sends a request, its delegates are called by Wait as the answer arrives */
+	void Send(const FString &Request, FOnDone OnDone, FOnData OnData = FOnData());
+
+	/** Waits until at most MaxOutstanding requests are unanswered, returns false if the server exited */
+	bool Wait(int32 MaxOutstanding = 0);
+
+	int32 NumOutstanding() const { return Outstanding.Num(); }
+
+private:
+	struct FRequest
+	{
+		FOnData OnData;
+		FOnDone OnDone;
+	};
+
+	void ReceiveOutput(const FString &Output);
+	void Dispatch(const FString &Response);
+
+	FString Executable, Params;
+	TUniquePtr<FInteractiveProcess> Process;
+	TMap<int32, FRequest> Outstanding;
+	int32 NextId;
+
+	// Filled by the process thread
+	FString Partial;
+	TQueue<FString, EQueueMode::Spsc> Responses;
+	FThreadSafeBool bExited;
+	FEvent * ResponseEvent;
+};
@@ -13,7 +13,8 @@ public class UDKImportPlugin : ModuleRules
 				"CoreUObject",		// @todo Mac: for some reason CoreUObject and Engine are needed to link in debug on Mac
 				"InputCore",
 				"SlateCore",
-				"Slate"
+				"Slate",
+				"T3DParserCore"
 			}
 		);
 			
@@ -24,6 +25,7 @@ public class UDKImportPlugin : ModuleRules
 				"Landscape",
 				"LevelEditor",
 				"AssetTools",
+				"T3DCorpus",
 			}
 		);
 	}
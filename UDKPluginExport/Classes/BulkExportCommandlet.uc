@@ -0,0 +1,73 @@
+/**
+ * Runs several batchexport in a single UDK process.
+ * Usage: run UDKPluginExport.BulkExport Manifest=Name Package|Class|Format|Folder ...
+ * Every export is recorded in UDKGame/Logs/Name.txt as Package|Class|Format|Folder|ReturnCode
+ */
+class BulkExportCommandlet extends Commandlet;
+
+event int Main( string Params )
+{
+	local array<string> Entries;
+	local array<string> Fields;
+	local class<Commandlet> BatchExportClass;
+	local Commandlet BatchExport;
+	local FileWriter Manifest;
+	local string ManifestName;
+	local int i, Result;
+
+	ParseStringIntoArray(Params, Entries, " ", true);
+
+	i = 0;
+	while (i < Entries.Length)
+	{
+		if (Left(Entries[i], 9) ~= "Manifest=")
+		{
+			ManifestName = Mid(Entries[i], 9);
+			Entries.Remove(i, 1);
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	// batchexport is a native UnrealEd commandlet, it is only reachable by name
+	BatchExportClass = class<Commandlet>(DynamicLoadObject("UnrealEd.BatchExportCommandlet", class'Class'));
+	if (BatchExportClass == None)
+	{
+		`Log("Unable to load UnrealEd.BatchExportCommandlet");
+		return 1;
+	}
+
+	Manifest = class'Engine'.static.GetCurrentWorldInfo().Spawn(class'FileWriter');
+	if (Manifest == None || ManifestName == "")
+	{
+		`Log("Unable to create the manifest" @ ManifestName);
+		return 1;
+	}
+	Manifest.OpenFile(ManifestName, FWFT_Log, ".txt", false, false);
+
+	for(i = 0; i < Entries.Length; ++i)
+	{
+		ParseStringIntoArray(Entries[i], Fields, "|", false);
+		if (Fields.Length != 4)
+		{
+			`Log("Invalid export" @ Entries[i]);
+			continue;
+		}
+
+		BatchExport = new BatchExportClass;
+		Result = BatchExport.Main(Fields[0] @ Fields[1] @ Fields[2] @ Fields[3]);
+		Manifest.Logf(Entries[i] $ "|" $ Result);
+	}
+
+	Manifest.CloseFile();
+	Manifest.Destroy();
+
+	return 0;
+}
+
+defaultproperties
+{
+	LogToConsole=true
+}
@@ -0,0 +1,155 @@
+/**
+ * Walks the references of StaticMeshes, Materials and MaterialInstanceConstants in a single UDK process.
+ * Usage: run UDKPluginExport.ExportDependencies Output=Name [List=Name] Url ...
+ * With List, the Roots of the [Name ExportDependenciesList] section of UDKPluginDependencies.ini are also walked.
+ * Every reference of the closure is written to UDKGame/Logs/Name.txt, one FromUrl<tab>Kind<tab>ToUrl record per line.
+ * Kind is the material slot of a StaticMesh, Parent or Texture.
+ */
+class ExportDependenciesCommandlet extends Commandlet;
+
+var ExportStaticMeshMaterialsCommandlet Names;
+var StaticMeshComponent SMC;
+var array<Object> Visited;
+var array<Object> Pending;
+
+function AddEdge(Object From, string Kind, Object To, out array<string> Edges)
+{
+	if (To == None)
+		return;
+
+	Edges.AddItem(Names.FullName(From) $ Chr(9) $ Kind $ Chr(9) $ Names.FullName(To));
+	if (Visited.Find(To) == INDEX_NONE)
+	{
+		Visited.AddItem(To);
+		Pending.AddItem(To);
+	}
+}
+
+/** Appends the references of the closure of Roots, objects already walked by a previous call are skipped */
+function Walk(array<string> Roots, out array<string> Edges)
+{
+	local Object O;
+	local StaticMesh SM;
+	local Material M;
+	local MaterialInstanceConstant MIC;
+	local MaterialExpressionTextureSample TextureSample;
+	local int i;
+
+	if (Names == None)
+	{
+		Names = new class'ExportStaticMeshMaterialsCommandlet';
+		SMC = new (self) class'StaticMeshComponent';
+	}
+
+	for(i = 0; i < Roots.Length; ++i)
+	{
+		O = DynamicLoadObject(Roots[i], class'Object');
+		if (O != None && Visited.Find(O) == INDEX_NONE)
+		{
+			Visited.AddItem(O);
+			Pending.AddItem(O);
+		}
+	}
+
+	while (Pending.Length > 0)
+	{
+		O = Pending[Pending.Length - 1];
+		Pending.Remove(Pending.Length - 1, 1);
+
+		SM = StaticMesh(O);
+		if (SM != None)
+		{
+			SMC.SetStaticMesh(SM);
+			for(i = 0; i < SMC.GetNumElements(); ++i)
+			{
+				AddEdge(SM, string(i), SMC.GetMaterial(i), Edges);
+			}
+		}
+
+		MIC = MaterialInstanceConstant(O);
+		if (MIC != None)
+		{
+			AddEdge(MIC, "Parent", MIC.Parent, Edges);
+			for(i = 0; i < MIC.TextureParameterValues.Length; ++i)
+			{
+				AddEdge(MIC, "Texture", MIC.TextureParameterValues[i].ParameterValue, Edges);
+			}
+		}
+
+		M = Material(O);
+		if (M != None)
+		{
+			for(i = 0; i < M.Expressions.Length; ++i)
+			{
+				TextureSample = MaterialExpressionTextureSample(M.Expressions[i]);
+				if (TextureSample != None)
+				{
+					AddEdge(M, "Texture", TextureSample.Texture, Edges);
+				}
+			}
+		}
+	}
+}
+
+event int Main( string Params )
+{
+	local array<string> Roots, Edges;
+	local ExportDependenciesList List;
+	local FileWriter Output;
+	local string OutputName, ListName;
+	local int i;
+
+	ParseStringIntoArray(Params, Roots, " ", true);
+
+	i = 0;
+	while (i < Roots.Length)
+	{
+		if (Left(Roots[i], 7) ~= "Output=")
+		{
+			OutputName = Mid(Roots[i], 7);
+			Roots.Remove(i, 1);
+		}
+		else if (Left(Roots[i], 5) ~= "List=")
+		{
+			ListName = Mid(Roots[i], 5);
+			Roots.Remove(i, 1);
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	if (ListName != "")
+	{
+		List = new(None, ListName) class'ExportDependenciesList';
+		for(i = 0; i < List.Roots.Length; ++i)
+		{
+			Roots.AddItem(List.Roots[i]);
+		}
+	}
+
+	Output = class'Engine'.static.GetCurrentWorldInfo().Spawn(class'FileWriter');
+	if (Output == None || OutputName == "")
+	{
+		`Log("Unable to create the output" @ OutputName);
+		return 1;
+	}
+	Output.OpenFile(OutputName, FWFT_Log, ".txt", false, false);
+
+	Walk(Roots, Edges);
+	for(i = 0; i < Edges.Length; ++i)
+	{
+		Output.Logf(Edges[i]);
+	}
+
+	Output.CloseFile();
+	Output.Destroy();
+
+	return 0;
+}
+
+defaultproperties
+{
+	LogToConsole=true
+}
@@ -0,0 +1,8 @@
+/**
+ * Root list of ExportDependenciesCommandlet, read from the [Name ExportDependenciesList] section of UDKPluginDependencies.ini.
+ */
+class ExportDependenciesList extends Object
+	config(PluginDependencies)
+	perobjectconfig;
+
+var config array<string> Roots;
@@ -0,0 +1,78 @@
+/**
+ * Exports single objects instead of whole packages, only their packages are loaded.
+ * Usage: run UDKPluginExport.ExportObjects Manifest=Name Class|ObjectPath|File ...
+ * The exporter is chosen by the extension of File, as in batchexport.
+ * Every export is recorded in UDKGame/Logs/Name.txt as Class|ObjectPath|File|ReturnCode
+ */
+class ExportObjectsCommandlet extends Commandlet;
+
+/** Exports Class|ObjectPath|File, returns 1 if the object can not be loaded */
+static function int ExportObject(string Entry)
+{
+	local array<string> Fields;
+	local class<Object> ObjectClass;
+	local Object Obj;
+
+	ParseStringIntoArray(Entry, Fields, "|", false);
+	if (Fields.Length != 3)
+		return 1;
+
+	ObjectClass = class<Object>(DynamicLoadObject("Engine." $ Fields[0], class'Class'));
+	if (ObjectClass == None)
+		return 1;
+
+	Obj = DynamicLoadObject(Fields[1], ObjectClass);
+	if (Obj == None)
+		return 1;
+
+	// The editor exports any loaded object by its full path
+	class'Engine'.static.GetCurrentWorldInfo().ConsoleCommand("OBJ EXPORT TYPE=" $ Fields[0] @ "NAME=" $ PathName(Obj) @ "FILE=" $ Fields[2]);
+	return 0;
+}
+
+event int Main( string Params )
+{
+	local array<string> Entries;
+	local FileWriter Manifest;
+	local string ManifestName;
+	local int i;
+
+	ParseStringIntoArray(Params, Entries, " ", true);
+
+	i = 0;
+	while (i < Entries.Length)
+	{
+		if (Left(Entries[i], 9) ~= "Manifest=")
+		{
+			ManifestName = Mid(Entries[i], 9);
+			Entries.Remove(i, 1);
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	Manifest = class'Engine'.static.GetCurrentWorldInfo().Spawn(class'FileWriter');
+	if (Manifest == None || ManifestName == "")
+	{
+		`Log("Unable to create the manifest" @ ManifestName);
+		return 1;
+	}
+	Manifest.OpenFile(ManifestName, FWFT_Log, ".txt", false, false);
+
+	for(i = 0; i < Entries.Length; ++i)
+	{
+		Manifest.Logf(Entries[i] $ "|" $ ExportObject(Entries[i]));
+	}
+
+	Manifest.CloseFile();
+	Manifest.Destroy();
+
+	return 0;
+}
+
+defaultproperties
+{
+	LogToConsole=true
+}
@@ -0,0 +1,124 @@
+/**
+ * Long running export server, packages loaded by a request stay loaded for the next ones.
+ * Usage: UDK.exe run UDKPluginExport.ExportServer
+ * Requests are read from the standard input, one per line: Id Command Args
+ * Each request is answered in order on the standard output by any number of "@Id > Data;" lines, then "@Id = ReturnCode;"
+ * Commands:
+ *  - export Package|Class|Format|Folder
+ *  - exportobject Class|ObjectPath|File, exports a single object
+ *  - meshmaterials StaticMeshUrl, answers a Slot<tab>MaterialUrl line per material slot
+ *  - dependencies Url, answers a FromUrl<tab>Kind<tab>ToUrl line per reference not walked by a previous request
+ *  - quit
+ */
+class ExportServerCommandlet extends Commandlet;
+
+var ExportServerPipe Pipe;
+var class<Commandlet> BatchExportClass;
+var ExportStaticMeshMaterialsCommandlet Names;
+var StaticMeshComponent SMC;
+var ExportDependenciesCommandlet Dependencies;
+
+function int Export(string Entry)
+{
+	local array<string> Fields;
+
+	ParseStringIntoArray(Entry, Fields, "|", false);
+	if (BatchExportClass == None || Fields.Length != 4)
+		return 1;
+
+	return (new BatchExportClass).Main(Fields[0] @ Fields[1] @ Fields[2] @ Fields[3]);
+}
+
+function int MeshMaterials(string Id, string Reference)
+{
+	local StaticMesh SM;
+	local int j;
+
+	SM = StaticMesh(DynamicLoadObject(Reference, class'StaticMesh'));
+	if (SM == None)
+		return 1;
+
+	SMC.SetStaticMesh(SM);
+	for(j = 0; j < SMC.GetNumElements(); ++j)
+	{
+		Pipe.WriteResponse("@" $ Id @ ">" @ j $ Chr(9) $ Names.FullName(SMC.GetMaterial(j)) $ ";");
+	}
+
+	return 0;
+}
+
+function int WalkDependencies(string Id, string Reference)
+{
+	local array<string> Roots, Edges;
+	local int j;
+
+	Roots.AddItem(Reference);
+	Dependencies.Walk(Roots, Edges);
+	for(j = 0; j < Edges.Length; ++j)
+	{
+		Pipe.WriteResponse("@" $ Id @ ">" @ Edges[j] $ ";");
+	}
+
+	return 0;
+}
+
+event int Main( string Params )
+{
+	local array<string> Args;
+	local string Request, Id, Command;
+	local int Result;
+
+	Pipe = new class'ExportServerPipe';
+	Names = new class'ExportStaticMeshMaterialsCommandlet';
+	SMC = new (self) class'StaticMeshComponent';
+	Dependencies = new class'ExportDependenciesCommandlet';
+	BatchExportClass = class<Commandlet>(DynamicLoadObject("UnrealEd.BatchExportCommandlet", class'Class'));
+
+	Request = Pipe.ReadRequest();
+	while (Request != "")
+	{
+		ParseStringIntoArray(Request, Args, " ", true);
+		if (Args.Length >= 2)
+		{
+			Id = Args[0];
+			Command = Args[1];
+
+			if (Command ~= "quit")
+			{
+				Pipe.WriteResponse("@" $ Id @ "= 0;");
+				return 0;
+			}
+			else if (Command ~= "export" && Args.Length == 3)
+			{
+				Result = Export(Args[2]);
+			}
+			else if (Command ~= "exportobject" && Args.Length == 3)
+			{
+				Result = class'ExportObjectsCommandlet'.static.ExportObject(Args[2]);
+			}
+			else if (Command ~= "meshmaterials" && Args.Length == 3)
+			{
+				Result = MeshMaterials(Id, Args[2]);
+			}
+			else if (Command ~= "dependencies" && Args.Length == 3)
+			{
+				Result = WalkDependencies(Id, Args[2]);
+			}
+			else
+			{
+				Result = 1;
+			}
+
+			Pipe.WriteResponse("@" $ Id @ "=" @ Result $ ";");
+		}
+
+		Request = Pipe.ReadRequest();
+	}
+
+	return 0;
+}
+
+defaultproperties
+{
+	LogToConsole=false
+}
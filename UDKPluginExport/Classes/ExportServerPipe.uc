@@ -0,0 +1,11 @@
+/**
+ * Standard input and output of the UDK process, implemented by UDKExportPipe.dll (see DLL/UDKExportPipe.cpp).
+ */
+class ExportServerPipe extends Object
+	DLLBind(UDKExportPipe);
+
+/** Next non empty line of the standard input, empty once the input is closed */
+dllimport final function string ReadRequest();
+
+/** Writes a line to the standard output */
+dllimport final function WriteResponse(string Line);
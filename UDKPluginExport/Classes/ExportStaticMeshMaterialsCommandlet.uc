@@ -18,15 +18,63 @@ function string FullName(Object O)
 	return ClassName $ "'" $ Url$ "'";
 }
 
+/**
+ * Usage: run UDKPluginExport.ExportStaticMeshMaterials [Output=Name] [List=Name] StaticMeshUrl ...
+ * With List, the StaticMeshes of the [Name ExportStaticMeshMaterialsList] section of UDKPluginExport.ini are also queried.
+ * With Output, material slots are written to UDKGame/Logs/Name.txt, one StaticMeshUrl<tab>Slot<tab>MaterialUrl record per line.
+ * Without Output, they are logged as "StaticMeshUrl Slot MaterialUrl".
+ */
 event int Main( string Params )
 {
 	local array<string> References;
 	local StaticMesh SM;
 	local StaticMeshComponent SMC;
+	local FileWriter Output;
+	local ExportStaticMeshMaterialsList List;
+	local string OutputName, ListName;
 	local int i, j;
 
 	ParseStringIntoArray(Params, References, " ", true);
 
+	i = 0;
+	while (i < References.Length)
+	{
+		if (Left(References[i], 7) ~= "Output=")
+		{
+			OutputName = Mid(References[i], 7);
+			References.Remove(i, 1);
+		}
+		else if (Left(References[i], 5) ~= "List=")
+		{
+			ListName = Mid(References[i], 5);
+			References.Remove(i, 1);
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	if (ListName != "")
+	{
+		List = new(None, ListName) class'ExportStaticMeshMaterialsList';
+		for(i = 0; i < List.StaticMeshes.Length; ++i)
+		{
+			References.AddItem(List.StaticMeshes[i]);
+		}
+	}
+
+	if (OutputName != "")
+	{
+		Output = class'Engine'.static.GetCurrentWorldInfo().Spawn(class'FileWriter');
+		if (Output == None)
+		{
+			`Log("Unable to create the output" @ OutputName);
+			return 1;
+		}
+		Output.OpenFile(OutputName, FWFT_Log, ".txt", false, false);
+	}
+
 	SMC = new (self) class'StaticMeshComponent';
 
 	for(i = 0; i < References.Length; ++i)
@@ -36,10 +84,23 @@ event int Main( string Params )
 	
 		for(j = 0; j < SMC.GetNumElements(); ++j)
 		{
-			`Log(References[i] @ j @ FullName(SMC.GetMaterial(j)));
+			if (Output != None)
+			{
+				Output.Logf(References[i] $ Chr(9) $ j $ Chr(9) $ FullName(SMC.GetMaterial(j)));
+			}
+			else
+			{
+				`Log(References[i] @ j @ FullName(SMC.GetMaterial(j)));
+			}
 		}
 	}
 
+	if (Output != None)
+	{
+		Output.CloseFile();
+		Output.Destroy();
+	}
+
 	return 0;
 }
 
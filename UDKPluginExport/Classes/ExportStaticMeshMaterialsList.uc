@@ -0,0 +1,9 @@
+/**
+ * StaticMesh list of ExportStaticMeshMaterialsCommandlet, read from the [Name ExportStaticMeshMaterialsList] section of UDKPluginExport.ini.
+ * Lets a single run cover more meshes than the command line can hold.
+ */
+class ExportStaticMeshMaterialsList extends Object
+	config(PluginExport)
+	perobjectconfig;
+
+var config array<string> StaticMeshes;
@@ -0,0 +1,66 @@
+// UDKExportPipe.dll, bound by ExportServerPipe.uc
+// Build as a 64 bits DLL (cl /LD /O2 UDKExportPipe.cpp) and copy it to UDKPath/Binaries/Win64/UserCode
+
+#include <windows.h>
+#include <string>
+
+static char Buffer[64 * 1024];
+static DWORD BufferStart = 0, BufferEnd = 0;
+static std::wstring Request;
+
+/** Next non empty UTF-8 line of the standard input, empty once the input is closed */
+extern "C" __declspec(dllexport) wchar_t * ReadRequest()
+{
+	HANDLE Input = GetStdHandle(STD_INPUT_HANDLE);
+	std::string Line;
+
+	for (;;)
+	{
+		if (BufferStart == BufferEnd)
+		{
+			BufferStart = 0;
+			if (!ReadFile(Input, Buffer, sizeof(Buffer), &BufferEnd, NULL) || BufferEnd == 0)
+			{
+				BufferEnd = 0;
+				Line.clear();
+				break;
+			}
+		}
+
+		const char * Start = Buffer + BufferStart;
+		const char * End = (const char *)memchr(Start, '\n', BufferEnd - BufferStart);
+		if (End == NULL)
+		{
+			Line.append(Start, BufferEnd - BufferStart);
+			BufferStart = BufferEnd;
+			continue;
+		}
+
+		Line.append(Start, End - Start);
+		BufferStart = (DWORD)(End - Buffer) + 1;
+
+		if (!Line.empty() && Line.back() == '\r')
+			Line.pop_back();
+		if (!Line.empty())
+			break;
+	}
+
+	Request.resize(Line.size());
+	const int Len = MultiByteToWideChar(CP_UTF8, 0, Line.data(), (int)Line.size(), &Request[0], (int)Request.size());
+	Request.resize(Len > 0 ? Len : 0);
+	return &Request[0];
+}
+
+/** Writes a UTF-8 line to the standard output */
+extern "C" __declspec(dllexport) void WriteResponse(wchar_t * Line)
+{
+	const int WideLen = (int)wcslen(Line);
+	std::string Utf8(WideLen * 3 + 1, '\0');
+	int Len = WideCharToMultiByte(CP_UTF8, 0, Line, WideLen, &Utf8[0], (int)Utf8.size(), NULL, NULL);
+	Utf8.resize(Len > 0 ? Len : 0);
+	Utf8 += '\n';
+
+	// A single write per line, so the client never sees a partial response
+	DWORD Written;
+	WriteFile(GetStdHandle(STD_OUTPUT_HANDLE), Utf8.data(), (DWORD)Utf8.size(), &Written, NULL);
+}
@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""Stand-in for ExportServerCommandlet, speaks the same protocol without UDK.
+
+Used by the UDKImport.BenchmarkExportServer console command to measure the client.
+Usage: ExportServerStandIn.py [Delay=Milliseconds] [Slots=MaterialSlotsPerMesh]
+"""
+
+import sys
+import time
+
+
+def main():
+    delay = 0.0
+    slots = 2
+    for arg in sys.argv[1:]:
+        if arg.startswith("Delay="):
+            delay = float(arg[6:]) / 1000.0
+        elif arg.startswith("Slots="):
+            slots = int(arg[6:])
+
+    out = sys.stdout
+    for line in sys.stdin:
+        args = line.split()
+        if len(args) < 2:
+            continue
+
+        request_id, command = args[0], args[1].lower()
+        if delay > 0:
+            time.sleep(delay)
+
+        if command == "quit":
+            out.write("@%s = 0;\n" % request_id)
+            out.flush()
+            return 0
+        elif command in ("export", "exportobject") and len(args) == 3:
+            result = 0
+        elif command == "meshmaterials" and len(args) == 3:
+            for slot in range(slots):
+                out.write("@%s > %d\tMaterial'StandIn.Materials.M_%d';\n" % (request_id, slot, slot))
+            result = 0
+        elif command == "dependencies" and len(args) == 3:
+            for slot in range(slots):
+                out.write("@%s > %s\t%d\tMaterial'StandIn.Materials.M_%d';\n" % (request_id, args[2], slot, slot))
+            result = 0
+        else:
+            result = 1
+
+        out.write("@%s = %d;\n" % (request_id, result))
+        out.flush()
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())